@@ -63,4 +63,22 @@ workspace("HorseCompiler")
             "src/Test/**.h",
             "src/Test/**.c",
             "src/Test/**.cpp"
+        }
+
+    project("Benchmark")
+        location "solution/Benchmark/"
+        targetdir "%{sln.location}/../bin/Benchmark/%{cfg.buildcfg}/"
+        objdir "%{sln.location}/../bin/Benchmark/%{cfg.buildcfg}/intermediates/"
+        
+        kind "ConsoleApp"
+
+        dependson "HorseCompiler"
+        links "HorseCompiler"
+        
+        includedirs "src/HorseCompiler/"
+
+        files {
+            "src/Benchmark/**.h",
+            "src/Benchmark/**.c",
+            "src/Benchmark/**.cpp"
         }
\ No newline at end of file
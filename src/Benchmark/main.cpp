@@ -0,0 +1,388 @@
+#include <core/log/log.h>
+#include <util/list.h>
+#include <util/string.h>
+#include <util/util.h>
+#include <core/compiler/compiler.h>
+#include <core/compiler/misc/symboltable.h>
+#include <core/compiler/lexer/lexer.h>
+#include <core/compiler/parsing/syntax.h>
+#include <core/compiler/semantic/semantic.h>
+#include <core/preprocessor/preprocessor.h>
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+
+static double GetElapsed(std::chrono::high_resolution_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+// Declares numGlobals globals with the same redefinition check the semantic pass does and looks every one of them up,
+// first from the global scope and then from inside nested scopes that each shadow one of the globals
+static bool BenchmarkSymbols(uint32 numGlobals) {
+	constexpr uint32 depth = 64;
+
+	List<NameId> names(numGlobals);
+	char         buf[32];
+
+	for (uint32 i = 0; i < numGlobals; i++) {
+		snprintf(buf, sizeof(buf), "g%u", i);
+		names.PushBack(NameTable::Add(String(buf)));
+	}
+
+	SymbolTable symbols;
+
+	auto start = std::chrono::high_resolution_clock::now();
+
+	for (NameId name : names) {
+		bool sameScope = false;
+
+		if (symbols.GetSymbol(name, &sameScope) != nullptr && sameScope) {
+			Log::Error("\"%s\" is already defined", NameTable::Get(name).str);
+			return false;
+		}
+
+		symbols.AddSymbol(new SymbolVariable(name, nullptr, false, CompactLocation()));
+	}
+
+	double declareTime = GetElapsed(start);
+	uint64 found       = 0;
+
+	start = std::chrono::high_resolution_clock::now();
+
+	for (NameId name : names) {
+		found += symbols.GetSymbol(name) != nullptr;
+	}
+
+	double globalTime = GetElapsed(start);
+
+	for (uint32 i = 0; i < depth; i++) {
+		symbols.PushScope();
+		symbols.AddSymbol(new SymbolVariable(names[i % numGlobals], nullptr, false, CompactLocation()));
+	}
+
+	start = std::chrono::high_resolution_clock::now();
+
+	for (NameId name : names) {
+		found += symbols.GetSymbol(name) != nullptr;
+	}
+
+	double nestedTime = GetElapsed(start);
+
+	for (uint32 i = 0; i < depth; i++) {
+		symbols.PopScope();
+	}
+
+	Log::Info("symbols: %u globals declared in %.3f ms", numGlobals, declareTime);
+	Log::Info("symbols: %u lookups in %.3f ms from the global scope, %.3f ms from %u scopes deep", numGlobals, globalTime, nestedTime, depth);
+
+	if (found != (uint64)numGlobals * 2) {
+		Log::Error("only %llu of %llu lookups found their symbol", found, (uint64)numGlobals * 2);
+		return false;
+	}
+
+	return true;
+}
+
+// Parses "float x = 1 + 1 * 1 - 1 / 1 ...;" with numTerms terms, a long chain of mixed precedence operators
+static bool BenchmarkExpression(uint32 numTerms) {
+	static const char* operators[] = { " + ", " * ", " - ", " / " };
+
+	String source("float x = 1");
+
+	for (uint32 i = 1; i < numTerms; i++) {
+		source.Append(operators[i % 4]).Append("1");
+	}
+
+	source.Append(";\n");
+
+	Tokens   tokens = Lexer::Analyze(new SourceFile(String("<expression>"), source), Language::Default());
+	ASTNode* root   = new ASTNode(ASTType::Root);
+
+	auto start = std::chrono::high_resolution_clock::now();
+
+	uint64 res = Syntax::Analyze(tokens, 0, root, Language::Default());
+
+	double time = GetElapsed(start);
+
+	Log::Info("expression: %u terms (%llu tokens) parsed in %.3f ms", numTerms, tokens.GetSize(), time);
+
+	return res != ~0;
+}
+
+// Parses the tokens of a file repeated repeat times, the time reported is the best of a few runs
+static bool BenchmarkParse(const String& filename, uint32 repeat) {
+	constexpr uint32 runs = 7;
+
+	Tokens file = Lexer::Analyze(filename, Language::Default());
+	Tokens tokens;
+
+	for (uint32 i = 0; i < repeat; i++) {
+		for (const Token& token : file) {
+			tokens.PushBack(token);
+		}
+	}
+
+	double best = 0.0;
+
+	for (uint32 i = 0; i < runs; i++) {
+		ASTNode* root = new ASTNode(ASTType::Root);
+
+		auto start = std::chrono::high_resolution_clock::now();
+
+		uint64 res = Syntax::Analyze(tokens, 0, root, Language::Default());
+
+		double time = GetElapsed(start);
+
+		if (res == ~0)
+			return false;
+
+		if (i == 0 || time < best)
+			best = time;
+	}
+
+	Log::Info("parse: %llu tokens (\"%s\" %u times) parsed in %.3f ms, best of %u runs", tokens.GetSize(), filename.str, repeat, best, runs);
+
+	return true;
+}
+
+// Hashes one line per node with everything the passes fill in, two trees are the same if their hashes are
+static uint64 HashTree(const ASTNode* node, uint32 depth, uint64 hash) {
+	char buf[256];
+	int  length = snprintf(buf, sizeof(buf), "%u %u %llu:%llu type %u category %u", depth, (uint32)node->nodeType, (uint64)node->loc.line, (uint64)node->loc.column, node->typeId, (uint32)node->category);
+
+	hash = HashUtils::FNV1a(buf, length, hash);
+
+	if (node->nodeType == ASTType::String) {
+		const String& name = ((const StringNode*)node)->GetString();
+
+		hash = HashUtils::FNV1a(name.str, name.length, hash);
+	} else if (node->nodeType == ASTType::Operator) {
+		length = snprintf(buf, sizeof(buf), " operator %u", (uint32)((const OperatorNode*)node)->type);
+		hash   = HashUtils::FNV1a(buf, length, hash);
+	} else if (node->nodeType == ASTType::Constant) {
+		const ConstantValue& value = ((const ConstantNode*)node)->value;
+
+		length = snprintf(buf, sizeof(buf), " constant %u 0x%llx", (uint32)value.type, value.Hash());
+		hash   = HashUtils::FNV1a(buf, length, hash);
+	} else if (node->nodeType == ASTType::Type) {
+		for (const TypeToken& token : ((const TypeNode*)node)->tokens) {
+			if (token.name != NameTable::Invalid) {
+				const String& name = NameTable::Get(token.name);
+
+				hash = HashUtils::FNV1a(name.str, name.length, hash);
+			}
+		}
+	}
+
+	for (const ASTNode* branch : node->branches) {
+		hash = HashTree(branch, depth + 1, hash);
+	}
+
+	return hash;
+}
+
+static uint64 HashLog(const LogBuffer& log, uint64 hash = 0xcbf29ce484222325) {
+	for (const LogBuffer::Message& message : log.messages) {
+		hash = HashUtils::FNV1a(&message.level, sizeof(message.level), hash);
+		hash = HashUtils::FNV1a(message.text.str, message.text.length, hash);
+	}
+
+	return hash;
+}
+
+// Runs the preprocessor, parser and semantic pass on one file, returns a hash of the diagnostics and the tree
+static uint64 CompileFile(const String& filename) {
+	Compiler     compiler(String("."), Language::Default());
+	List<String> includeDirs;
+	LogBuffer    log;
+
+	Log::BeginCapture(&log);
+
+	Tokens       tokens = Lexer::Analyze(filename, Language::Default());
+	PreProcessor pp(includeDirs, &compiler);
+	ASTNode*     root = new ASTNode(ASTType::Root);
+
+	if (pp.Run(tokens) && Syntax::Analyze(tokens, 0, root, Language::Default()) != ~0) {
+		SymbolTable  symbols;
+		TypeTable    types;
+		ConstantPool constants;
+
+		Semantic::Analyze(root, &types, &symbols, &constants, nullptr, 1);
+	}
+
+	Log::EndCapture();
+
+	return HashTree(root, 0, HashLog(log));
+}
+
+// Analyzes a fresh tree of the tokens on numThreads threads, returns a hash of the diagnostics and the tree
+static uint64 AnalyzeTokens(Tokens& tokens, uint32 numThreads, uint64* numDiagnostics, double* time) {
+	ASTNode*     root = new ASTNode(ASTType::Root);
+	SymbolTable  symbols;
+	TypeTable    types;
+	ConstantPool constants;
+	LogBuffer    log;
+
+	Syntax::Analyze(tokens, 0, root, Language::Default());
+
+	Log::BeginCapture(&log);
+
+	auto start = std::chrono::high_resolution_clock::now();
+
+	Semantic::Analyze(root, &types, &symbols, &constants, nullptr, numThreads);
+
+	*time = GetElapsed(start);
+
+	Log::EndCapture();
+
+	*numDiagnostics = log.messages.size();
+
+	return HashTree(root, 0, HashLog(log));
+}
+
+// Analyzes numFunctions generated functions with foldable constants, every 16th has a division by zero, once on
+// one thread and once on numThreads threads. Both runs have to report the same diagnostics and fold the same trees
+static bool BenchmarkSemantic(uint32 numFunctions, uint32 numThreads) {
+	String source("const int k = 3;\nstruct S { float a; vec3 b; };\n");
+	char   buf[256];
+
+	for (uint32 i = 0; i < numFunctions; i++) {
+		snprintf(buf, sizeof(buf), "float f%u(float x, int y) {\n\tconst int c = k * %u + 2;\n\tconst int d = c / %u;\n\tfloat z = x * %u.5 + c;\n\treturn z * (x - d);\n}\n", i, i, i % 16, i);
+		source.Append(buf);
+	}
+
+	Tokens tokens = Lexer::Analyze(new SourceFile(String("<semantic>"), source), Language::Default());
+
+	uint64 serialDiagnostics   = 0;
+	uint64 parallelDiagnostics = 0;
+	double serialTime          = 0.0;
+	double parallelTime        = 0.0;
+
+	uint64 serial   = AnalyzeTokens(tokens, 1, &serialDiagnostics, &serialTime);
+	uint64 parallel = AnalyzeTokens(tokens, numThreads, &parallelDiagnostics, &parallelTime);
+
+	Log::Info("semantic: %u functions analyzed in %.3f ms on one thread, %.3f ms on %u threads, %llu diagnostics", numFunctions, serialTime, parallelTime, numThreads, serialDiagnostics);
+
+	if (serial != parallel || serialDiagnostics != parallelDiagnostics) {
+		Log::Error("the diagnostics or trees differ between one and %u threads", numThreads);
+		return false;
+	}
+
+	return true;
+}
+
+// Compiles every file once on this thread, then each of them rounds times spread over numThreads threads and
+// checks that every concurrent compilation produced the same diagnostics and tree as the serial one
+static bool BenchmarkFrontend(uint32 numThreads, const List<String>& filenames) {
+	constexpr uint32 rounds = 64;
+
+	List<uint64> serial(filenames.GetSize());
+
+	auto start = std::chrono::high_resolution_clock::now();
+
+	for (const String& filename : filenames) {
+		serial.PushBack(CompileFile(filename));
+	}
+
+	double serialTime = GetElapsed(start);
+
+	List<uint64> concurrent(filenames.GetSize() * rounds);
+
+	for (uint64 i = 0; i < filenames.GetSize() * rounds; i++) {
+		concurrent.PushBack(0);
+	}
+
+	start = std::chrono::high_resolution_clock::now();
+
+	ThreadUtils::ParallelFor(concurrent.GetSize(), numThreads, [&](uint64 index) {
+		concurrent[index] = CompileFile(filenames[index % filenames.GetSize()]);
+	});
+
+	double concurrentTime = GetElapsed(start);
+	uint64 mismatches     = 0;
+
+	for (uint64 i = 0; i < concurrent.GetSize(); i++) {
+		if (concurrent[i] != serial[i % filenames.GetSize()])
+			mismatches++;
+	}
+
+	Log::Info("frontend: %llu files compiled in %.3f ms on one thread", filenames.GetSize(), serialTime);
+	Log::Info("frontend: %llu compilations in %.3f ms on %u threads", concurrent.GetSize(), concurrentTime, numThreads);
+
+	if (mismatches > 0) {
+		Log::Error("%llu of %llu concurrent compilations differ from the serial run", mismatches, concurrent.GetSize());
+		return false;
+	}
+
+	return true;
+}
+
+static uint32 GetCount(int argc, char** argv, int index, uint32 defaultCount) {
+	if (argc <= index)
+		return defaultCount;
+
+	uint32 count = (uint32)strtoul(argv[index], nullptr, 10);
+
+	if (count == 0)
+		Log::Error("invalid count \"%s\"", argv[index]);
+
+	return count;
+}
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		Log::Error("usage: %s <benchmark> [arguments]", argv[0]);
+		Log::Info("symbols [numGlobals]    declares and looks up globals in the symbol table, 100000 by default");
+		Log::Info("expression [numTerms]   parses a single expression, 10000 terms by default");
+		Log::Info("parse <file> [repeat]   parses the tokens of a file repeated 200 times by default");
+		Log::Info("semantic [numFunctions] [numThreads]   analyzes 1000 generated functions on one and 4 threads by default");
+		Log::Info("frontend <numThreads> <file>...   compiles the files concurrently and compares the result to a serial run");
+		return 1;
+	}
+
+	String benchmark(argv[1]);
+
+	if (benchmark == "symbols") {
+		uint32 numGlobals = GetCount(argc, argv, 2, 100000);
+
+		return numGlobals > 0 && BenchmarkSymbols(numGlobals) ? 0 : 1;
+	} else if (benchmark == "expression") {
+		uint32 numTerms = GetCount(argc, argv, 2, 10000);
+
+		return numTerms > 0 && BenchmarkExpression(numTerms) ? 0 : 1;
+	} else if (benchmark == "parse") {
+		if (argc < 3) {
+			Log::Error("usage: %s parse <file> [repeat]", argv[0]);
+			return 1;
+		}
+
+		uint32 repeat = GetCount(argc, argv, 3, 200);
+
+		return repeat > 0 && BenchmarkParse(String(argv[2]), repeat) ? 0 : 1;
+	} else if (benchmark == "semantic") {
+		uint32 numFunctions = GetCount(argc, argv, 2, 1000);
+		uint32 numThreads   = GetCount(argc, argv, 3, 4);
+
+		return numFunctions > 0 && numThreads > 0 && BenchmarkSemantic(numFunctions, numThreads) ? 0 : 1;
+	} else if (benchmark == "frontend") {
+		uint32 numThreads = GetCount(argc, argv, 2, ThreadUtils::GetNumThreads());
+
+		if (numThreads == 0 || argc < 4) {
+			Log::Error("usage: %s frontend <numThreads> <file>...", argv[0]);
+			return 1;
+		}
+
+		List<String> filenames;
+
+		for (int i = 3; i < argc; i++) {
+			filenames.PushBack(String(argv[i]));
+		}
+
+		return BenchmarkFrontend(numThreads, filenames) ? 0 : 1;
+	}
+
+	Log::Error("unknown benchmark \"%s\"", argv[1]);
+
+	return 1;
+}
@@ -27,7 +27,7 @@ SOFTWARE
 #include <util/util.h>
 #include <stdarg.h>
 
-Compiler::Compiler(const String& cwd, Language* language) : lang(language) {
+Compiler::Compiler(const String& cwd, const Language* language) : lang(language) {
 	currentDir = cwd;
 	StringUtils::ReplaceChar(currentDir, '\\', '/');
 
@@ -175,94 +175,155 @@ TypeMat* Compiler::MakeTypeMat(PrimitiveType type, uint8 constness) {
 
 
 
-void Compiler::Log(const Token& item, uint64 code, ...) {
-	va_list list;
-	va_start(list, code);
-
+// Shared by both Log overloads, string is the source text at the location
+static void LogCode(int64 line, int64 column, const char* file, const char* string, uint64 code, va_list list) {
 	switch (code) {
 		case HC_ERROR_SYNTAX_MISSING_STRING_CLOSE:
-			Log::Error(item.line, item.column, item.filename.str, code, "syntax error: missing closing string character '%c'", va_arg(list, char));
+			Log::Error(line, column, file, code, "syntax error: missing closing string character '%c'", va_arg(list, char));
 			break;
 		case HC_WARN_SYNTAX_INVALID_ESCAPE_CHARACTER:
-			Log::Warning(item.line, item.column + va_arg(list, uint64), item.filename.str, code, "syntax error: unrecognized escape character '%c' sequence", va_arg(list, char));
+			Log::Warning(line, column + va_arg(list, uint64), file, code, "syntax error: unrecognized escape character '%c' sequence", va_arg(list, char));
 			break;
 		case HC_ERROR_SYNTAX_INT_LITERAL_NO_DIGIT:
-			Log::Error(item.line, item.column + va_arg(list, uint64), item.filename.str, code, "syntax error: integer literal must have at least one digit");
+			Log::Error(line, column + va_arg(list, uint64), file, code, "syntax error: integer literal must have at least one digit");
 			break;
 		case HC_ERROR_SYNTAX_INT_LITERAL_TO_BIG:
-			Log::Error(item.line, item.column + va_arg(list, uint64), item.filename.str, code, "syntax error: integer literal to big for a character '%u'", va_arg(list, uint64));
+			Log::Error(line, column + va_arg(list, uint64), file, code, "syntax error: integer literal to big for a character '%u'", va_arg(list, uint64));
 			break;
 		case HC_ERROR_PREPROCESSOR_NO_DIRECTIVE:
-			Log::Error(item.line, item.column, item.filename.str, code, "preprocessor error: no directive");
+			Log::Error(line, column, file, code, "preprocessor error: no directive");
 			break;
 		case HC_ERROR_PREPROCESSOR_UNKNOWN_DIRECTIVE:
-			Log::Error(item.line, item.column, item.filename.str, code, "preprocessor error: unknown preprocessor directive '%s'", va_arg(list, char*));
+			Log::Error(line, column, file, code, "preprocessor error: unknown preprocessor directive '%s'", va_arg(list, char*));
 			break;
 		case HC_ERROR_PREPROCESSOR_INCLUDE_FILE_NOT_FOUND:
-			Log::Error(item.line, item.column, item.filename.str, code, "preprocessor error: no such file or directory \"%s\"", va_arg(list, char*));
+			Log::Error(line, column, file, code, "preprocessor error: no such file or directory \"%s\"", va_arg(list, char*));
 			break;
 		case HC_ERROR_PREPROCESSOR_INCLUDE_UNKNOWN_SYMBOL1:
-			Log::Error(item.line, item.column, item.filename.str, code, "preprocessor error: unkown symbol in include directive '%c', expected '\"' or '<'", va_arg(list, char));
+			Log::Error(line, column, file, code, "preprocessor error: unkown symbol in include directive '%c', expected '\"' or '<'", va_arg(list, char));
 			break;
 		case HC_ERROR_PREPROCESSOR_INCLUDE_UNKNOWN_SYMBOL2:
-			Log::Error(item.line, item.column, item.filename.str, code, "preprocessor error: unkown symbol in include directive '%c', expected '%c'", va_arg(list, char), va_arg(list, char));
+			Log::Error(line, column, file, code, "preprocessor error: unkown symbol in include directive '%c', expected '%c'", va_arg(list, char), va_arg(list, char));
 			break;
 		case HC_ERROR_PREPROCESSOR_INCLUDE_RECURSION:
-			Log::Error(item.line, item.column, item.filename.str, code, "preprocessor error: '%s' causes recursion", va_arg(list, char*));
+			Log::Error(line, column, file, code, "preprocessor error: '%s' causes recursion", va_arg(list, char*));
 			break;
 		case HC_WARN_PREPROCESSOR_PRAGMA_UNKNOWN_DIRECTIVE:
-			Log::Warning(item.line, item.column, item.filename.str, code, "preprocessor error: unknown pragma directive '%s'", va_arg(list, char*));
+			Log::Warning(line, column, file, code, "preprocessor error: unknown pragma directive '%s'", va_arg(list, char*));
 			break;
 		case HC_WARN_PREPROCESSOR_MACRO_REDEFINITION:
-			Log::Warning(item.line, item.column, item.filename.str, code, "preprocessor error: macro redefinition '%s'", va_arg(list, char*));
+			Log::Warning(line, column, file, code, "preprocessor error: macro redefinition '%s'", va_arg(list, char*));
 			break;
 		case HC_ERROR_PREPROCESSOR_ERROR_DIRECTIVE:
-			Log::Error(item.line, item.column, item.filename.str, code, "preprocessor error: '%s'", va_arg(list, char*));
+			Log::Error(line, column, file, code, "preprocessor error: '%s'", va_arg(list, char*));
 			break;
 		case HC_ERROR_LEXER_EOL:
-			Log::Error(item.line, item.column, item.filename.str, code, "lexer error: unexpected end of line");
+			Log::Error(line, column, file, code, "lexer error: unexpected end of line");
 			break;
 		case HC_ERROR_SYNTAX_CHAR_LITERAL_TO_MANY_CHARS:
-			Log::Error(item.line, item.column, item.filename.str, code, "syntax error: char literal has to many chars");
+			Log::Error(line, column, file, code, "syntax error: char literal has to many chars");
 			break;
 		case HC_ERROR_SYNTAX_EXPECTED:
-			Log::Error(item.line, item.column, item.filename.str, code, "syntax error: '%s' expected '%s'", item.string.str, va_arg(list, char*));
+			Log::Error(line, column, file, code, "syntax error: '%s' expected '%s'", string, va_arg(list, char*));
 			break;
 		case HC_ERROR_SYNTAX_ERROR:
-			Log::Error(item.line, item.column, item.filename.str, code, "syntax error: '%s'", item.string.str);
+			Log::Error(line, column, file, code, "syntax error: '%s'", string);
 			break;
 		case HC_ERROR_SYNTAX_ILLEGAL_VARIABLE_NAME:
-			Log::Error(item.line, item.column, item.filename.str, code, "syntax error: illegal name '%s', must start with '_', 'a-z' or 'A-Z'. And must not be a keyword or type", item.string.str);
+			Log::Error(line, column, file, code, "syntax error: illegal name '%s', must start with '_', 'a-z' or 'A-Z'. And must not be a keyword or type", string);
 			break;
 		case HC_ERROR_SYNTAX_VARIABLE_REDEFINITION:
-			Log::Error(item.line, item.column, item.filename.str, code, "syntax error: illegal name '%s', it already exist", item.string.str);
+			Log::Error(line, column, file, code, "syntax error: illegal name '%s', it already exist", string);
 			break;
 		case HC_ERROR_SYNTAX_EOL:
-			Log::Error(item.line, item.column, item.filename.str, code, "syntax error: unexpected end of file", item.string.str);
+			Log::Error(line, column, file, code, "syntax error: unexpected end of file", string);
 			break;
 		case HC_ERROR_SYNTAX_INVALID_OPERANDS:
-			Log::Error(item.line, item.column, item.filename.str, code, "syntax error: unexpected end of file", item.string.str);
+			Log::Error(line, column, file, code, "syntax error: unexpected end of file", string);
 			break;
 		case HC_ERROR_SYNTAX_ILLEGAL_TYPENAME:
-			Log::Error(item.line, item.column, item.filename.str, code, "syntax error: illegal name '%s', must start with '_', 'a-z' or 'A-Z'. And must not be a keyword or type", item.string.str);
+			Log::Error(line, column, file, code, "syntax error: illegal name '%s', must start with '_', 'a-z' or 'A-Z'. And must not be a keyword or type", string);
+			break;
+		case HC_ERROR_SYNTAX_INVALID_LITERAL:
+			Log::Error(line, column, file, code, "syntax error: invalid numeric literal '%s'", string);
+			break;
+		case HC_ERROR_SYNTAX_LITERAL_OUT_OF_RANGE:
+			Log::Error(line, column, file, code, "syntax error: literal '%s' is out of range", string);
 			break;
 		case HC_WARN_SEMANTIC_SAME_TYPE_QUALIFIER:
-			Log::Warning(item.line, item.column, item.filename.str, code, "semantic error: same type qualifier used more than once");
+			Log::Warning(line, column, file, code, "semantic error: same type qualifier used more than once");
 			break;
 		case HC_ERROR_SEMANTIC_SIGNED_UNSIGNED_EXCLUSIVE:
-			Log::Error(item.line, item.column, item.filename.str, code, "semantic error: signed/unsigned keywords are mutually exclusive");
+			Log::Error(line, column, file, code, "semantic error: signed/unsigned keywords are mutually exclusive");
 			break;
 		case HC_ERROR_SEMANTIC_TYPE_FOLLOWED_BY_TYPE:
-			Log::Error(item.line, item.column, item.filename.str, code, "semantic error: type '%s' followed by '%s' is illegal", va_arg(list, char*), va_arg(list, char*));
+			Log::Error(line, column, file, code, "semantic error: type '%s' followed by '%s' is illegal", va_arg(list, char*), va_arg(list, char*));
 			break;
 		case HC_ERROR_SEMANTIC_SIGNED_UNSIGNED_NOT_ALLOWED_ON_TYPE:
-			Log::Error(item.line, item.column, item.filename.str, code, "semantic error: '%s' not allowed on type '%s'", va_arg(list, char*), va_arg(list, char*));
+			Log::Error(line, column, file, code, "semantic error: '%s' not allowed on type '%s'", va_arg(list, char*), va_arg(list, char*));
+			break;
+		case HC_ERROR_SEMANTIC_SYMBOL_REDEFINITION:
+			Log::Error(line, column, file, code, "semantic error: symbol '%s' already exist: redefinition", string);
 			break;
 		case HC_WARN_SEMANTIC_PARENT_SCOPE_SYMBOL_REDEFINITION:
-			Log::Warning(item.line, item.column, item.filename.str, code, "semantic error: symbol in parent scope overridden");
+			Log::Warning(line, column, file, code, "semantic error: symbol in parent scope overridden");
 			break;
 		case HC_WARN_SEMANTIC_SYMBOL_REDEFINITION:
-			Log::Error(item.line, item.column, item.filename.str, code, "semantic error: symbol '%s' already exist: redefinition", va_arg(list, char*));
+			Log::Error(line, column, file, code, "semantic error: symbol '%s' already exist: redefinition", va_arg(list, char*));
+			break;
+		case HC_ERROR_SEMANTIC_TYPE_REDEFINITION:
+			Log::Error(line, column, file, code, "semantic error: type '%s' already exist: redefinition", string);
+			break;
+		case HC_ERROR_SEMANTIC_INVALID_OPERANDS:
+			Log::Error(line, column, file, code, "semantic error: invalid operands '%s' and '%s' to operator", va_arg(list, char*), va_arg(list, char*));
+			break;
+		case HC_ERROR_SEMANTIC_INVALID_OPERAND:
+			Log::Error(line, column, file, code, "semantic error: invalid operand '%s' to operator", va_arg(list, char*));
+			break;
+		case HC_ERROR_SEMANTIC_DIVISION_BY_ZERO:
+			Log::Error(line, column, file, code, "semantic error: integer division by zero");
+			break;
+		case HC_ERROR_SEMANTIC_SHIFT_OUT_OF_RANGE:
+			Log::Error(line, column, file, code, "semantic error: shift count is negative or not less than 32");
+			break;
+		case HC_ERROR_SEMANTIC_INDEX_OUT_OF_RANGE:
+			Log::Error(line, column, file, code, "semantic error: index out of range for '%s'", va_arg(list, char*));
+			break;
+		case HC_ERROR_SEMANTIC_INVALID_SWIZZLE:
+			Log::Error(line, column, file, code, "semantic error: invalid swizzle '%s' for '%s'", string, va_arg(list, char*));
+			break;
+		case HC_ERROR_SEMANTIC_INVALID_CONSTRUCTOR:
+			Log::Error(line, column, file, code, "semantic error: wrong number or type of arguments to constructor '%s'", string);
+			break;
+		case HC_ERROR_SEMANTIC_CONST_ASSIGNMENT:
+			Log::Error(line, column, file, code, "semantic error: cannot assign to const variable '%s'", string);
+			break;
+		case HC_ERROR_SEMANTIC_INVALID_CONVERSION:
+			Log::Error(line, column, file, code, "semantic error: cannot convert '%s' to '%s'", va_arg(list, char*), va_arg(list, char*));
+			break;
+		case HC_ERROR_SEMANTIC_INVALID_LAYOUT_PARAMETER:
+			Log::Error(line, column, file, code, "semantic error: layout parameter '%s' must be a non negative integer constant", string);
+			break;
+		case HC_ERROR_SEMANTIC_LOCAL_TYPE:
+			Log::Error(line, column, file, code, "semantic error: type '%s' must be declared at global scope", string);
 			break;
 	}
+}
+
+void Compiler::Log(const Token& item, uint64 code, ...) {
+	va_list list;
+	va_start(list, code);
+
+	LogCode(item.loc.line, item.loc.column, item.loc.file ? item.loc.file->filename.str : "", item.string.str, code, list);
+
+	va_end(list);
+}
+
+void Compiler::Log(const CompactLocation& loc, NameId name, uint64 code, ...) {
+	va_list list;
+	va_start(list, code);
+
+	LogCode(loc.line, loc.column, loc.GetFilename(), name == NameTable::Invalid ? "" : NameTable::Get(name).str, code, list);
+
+	va_end(list);
 }
\ No newline at end of file
@@ -33,15 +33,17 @@ SOFTWARE
 
 class Compiler {
 private:
-	String    currentDir;
-	Language* lang;
-	TypeTable typeTable;
+	String          currentDir;
+	const Language* lang;
+	TypeTable       typeTable;
 
 public:
-	Compiler(const String& currentDir, Language* lang);
+	Compiler(const String& currentDir, const Language* lang);
 
 private: // Internal functions
 
 public: //static stuff
 	static void Log(const Token& item, uint64 code, ...);
+	// For diagnostics after the tokens are released, name is the source text at the location
+	static void Log(const CompactLocation& loc, NameId name, uint64 code, ...);
 };
\ No newline at end of file
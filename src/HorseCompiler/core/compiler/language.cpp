@@ -24,14 +24,19 @@ SOFTWARE
 
 #include "language.h"
 
-Language* Language::Default() {
-    static Language lang;
+const Language* Language::Default() {
+	static const Language lang;
 
-	if (lang.initialized) return &lang;
+	return &lang;
+}
+
+Language::Language() {
+	Language& lang = *this;
 
 	lang.delimiters = " #=+-*/<>.,^&|(){}[]%\"'!?:;";
 	lang.stringStart = '"';
 	lang.stringEnd = '"';
+	lang.stringEscapeChar = '\\';
 	lang.charStart = '\'';
 	lang.charEnd = '\'';
 	lang.numSequences = 2;
@@ -142,9 +147,4 @@ Language* Language::Default() {
 	keywords.PushBack({ KeywordType::Sampler1D, "Sampler1D" });
 	keywords.PushBack({ KeywordType::Sampler2D, "Sampler2D" });
 	keywords.PushBack({ KeywordType::Sampler3D, "Sampler3D" });
-
-
-	lang.initialized = true;
-
-	return &lang;
 }
\ No newline at end of file
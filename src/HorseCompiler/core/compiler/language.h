@@ -56,7 +56,8 @@ enum class TokenType {
 	PrimitiveType,
 	Operator,
 	Identifier,
-	Literal
+	Literal,
+	EndOfFile // Padding after the last token, see TokenCursor
 };
 
 struct TokenTypeDef {
@@ -107,6 +108,8 @@ enum class OperatorType {
 	OpGreater,
 	OpLessEq,
 	OpGreaterEq,
+
+	OpCount // Number of operator types
 };
 
 enum class OperatorAssociativity {
@@ -184,7 +187,8 @@ struct PrimitiveTypeDef {
 
 class Language {
 private:
-	bool initialized = false;
+	Language();
+
 public:
 	String delimiters;
 	char   stringStart;
@@ -217,5 +221,6 @@ public:
 	List<PrimitiveTypeDef> primitiveTypes;
 	List<OperatorTypeDef>  operators;
 
-	static Language* Default();
+	// Constructed on first use and never modified after that, safe to share between threads
+	static const Language* Default();
 };
\ No newline at end of file
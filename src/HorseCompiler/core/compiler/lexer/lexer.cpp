@@ -30,23 +30,29 @@ SOFTWARE
 #include <util/util.h>
 
 #include <algorithm>
+#include <string.h>
 
 #define IN_STRING 0x01
 #define IN_INCLUDE 0x02
 #define IN_CHAR 0x03
 
-Tokens Lexer::Analyze(const String& filename, Language* lang) {
+Tokens Lexer::Analyze(const String& filename, const Language* lang) {
 	Lexer lex(lang);
 
-	return lex.Analyze(filename);
+	return lex.Analyze(new SourceFile(filename));
 }
 
-Tokens Lexer::Analyze(const String& filename) {
+Tokens Lexer::Analyze(SourceFile* sourceFile, const Language* lang) {
+	Lexer lex(lang);
+
+	return lex.Analyze(sourceFile);
+}
+
+Tokens Lexer::Analyze(SourceFile* sourceFile) {
 	Tokens result;
 	List<uint64> indices;
 	List<uint64> newLines;
 
-	SourceFile* sourceFile = new SourceFile(filename);
 	String& file = sourceFile->text;
 
 	result.Reserve(4096);
@@ -55,6 +61,10 @@ Tokens Lexer::Analyze(const String& filename) {
 
 	result.PushBack(Token());
 
+	List<std::pair<uint64, uint64>> comments;
+
+	FindComments(file, comments);
+
 	uint64 index = 0;
 
 	for (uint64 i = 0; i < lang->delimiters.length; i++) {
@@ -77,13 +87,67 @@ Tokens Lexer::Analyze(const String& filename) {
 
 	std::sort(indices.begin(), indices.end());
 
+	if (comments.GetSize() > 0) {
+		// Delimiters inside comments will never be reached
+		uint64 count   = 0;
+		uint64 comment = 0;
+
+		for (uint64 idx : indices) {
+			while (comment < comments.GetSize() && comments[comment].second < idx)
+				comment++;
+
+			if (comment < comments.GetSize() && comments[comment].first <= idx)
+				continue;
+
+			indices[count++] = idx;
+		}
+
+		if (count < indices.GetSize())
+			indices.Remove(count, indices.GetSize() - 1);
+	}
+
 	uint64 currLine = 0;
+	uint64 comment  = 0;
 	uint64 lastIndex = 0;
 
 	uint8 includeSpaces = false;
 	bool setNextSpace = true;
 
 	for (uint64 i = 0; i < file.length; i++) {
+		if (comment < comments.GetSize() && comments[comment].first == i) {
+			uint64 end = comments[comment++].second;
+
+			if ((int64)lastIndex <= (int64)i - 1) {
+				Token t;
+
+				t.loc = SourceLocation(sourceFile, lastIndex, currLine + 1, lastIndex - ((newLines[currLine - 1 * (currLine > 0)] + 1) * (currLine > 0)) + 1);
+				t.string = file.SubString(lastIndex, i - 1);
+				t.isString = includeSpaces;
+
+				uint64 tmp = 0;
+
+				while ((tmp = t.string.Find('\t', tmp)) != ~0) {
+					t.string.RemoveAt(tmp);
+				}
+
+				if (t.string.length > 0) {
+					result.PushBack(t);
+				}
+			}
+
+			// A comment separates tokens just like a space
+			result[result.GetSize() - 1].trailingSpace = true;
+			setNextSpace = false;
+
+			while (newLines[currLine] < end)
+				currLine++;
+
+			lastIndex = end + 1;
+			i = end;
+
+			continue;
+		}
+
 		char c = file[i];
 		for (uint64 j = 0; j < indices.GetSize(); j++) {
 			if (i == indices[j]) {
@@ -321,11 +385,75 @@ Tokens Lexer::Analyze(const String& filename) {
 }
 
 
+void Lexer::FindComments(const String& file, List<std::pair<uint64, uint64>>& comments) {
+	const char* const str = file.str;
+	const char* const end = str + file.length;
+	const char        delimiters[] = { '/', lang->stringStart, lang->charStart, 0 };
+
+	const char* curr = str;
+
+	while (curr < end && (curr = strpbrk(curr, delimiters)) != nullptr) {
+		char c = *curr;
+
+		if (c == lang->stringStart || c == lang->charStart) {
+			// Skip literals so "//" inside a string isn't treated as a comment
+			char close = c == lang->stringStart ? lang->stringEnd : lang->charEnd;
+
+			curr++;
+
+			while (curr < end) {
+				const char* next = (const char*)memchr(curr, close, end - curr);
+
+				if (next == nullptr) {
+					curr = end;
+					break;
+				}
+
+				uint64 escapes = 0;
+
+				while (next - escapes > curr && next[-1 - (int64)escapes] == lang->stringEscapeChar)
+					escapes++;
+
+				curr = next + 1;
+
+				if ((escapes & 1) == 0)
+					break;
+			}
+		} else if (curr + 1 < end && curr[1] == '/') {
+			const char* newLine = (const char*)memchr(curr + 2, '\n', end - curr - 2);
+			const char* last    = newLine ? newLine - 1 : end - 1;
+
+			comments.PushBack({ (uint64)(curr - str), (uint64)(last - str) });
+
+			curr = last + 1;
+		} else if (curr + 1 < end && curr[1] == '*') {
+			const char* star = curr + 2;
+			const char* last = end - 1;
+
+			while (star < end && (star = (const char*)memchr(star, '*', end - star)) != nullptr) {
+				if (star + 1 < end && star[1] == '/') {
+					last = star + 1;
+					break;
+				}
+
+				star++;
+			}
+
+			comments.PushBack({ (uint64)(curr - str), (uint64)(last - str) });
+
+			curr = last + 1;
+		} else {
+			curr++;
+		}
+	}
+}
+
 void Lexer::ParseLiteral(Tokens& tokens, uint64 index) {
 	Token& token = tokens[index++];
 
-	if (index >= tokens.GetSize() - 1) {
-		Compiler::Log(token, HC_ERROR_LEXER_EOL);
+	if (index >= tokens.GetSize()) {
+		// Last token, e.g the value of a define given on the command line
+		token.primitiveType = PrimitiveType::Int;
 		return;
 	}
 
@@ -337,10 +465,8 @@ void Lexer::ParseLiteral(Tokens& tokens, uint64 index) {
 
 		tokens.Remove(index);
 
-		if (index >= tokens.GetSize() - 1) {
-			Compiler::Log(token, HC_ERROR_LEXER_EOL);
+		if (index >= tokens.GetSize())
 			return;
-		}
 
 		Token& next = tokens[index];
 
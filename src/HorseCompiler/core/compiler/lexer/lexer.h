@@ -31,14 +31,18 @@ SOFTWARE
 
 class Lexer {
 public:
-	static Tokens Analyze(const String& filename, Language* lang);
+	static Tokens Analyze(const String& filename, const Language* lang);
+	static Tokens Analyze(SourceFile* sourceFile, const Language* lang);
 
 private:
-	Lexer(Language* lang) : lang(lang) {}
+	Lexer(const Language* lang) : lang(lang) {}
 
-	Language* lang;
+	const Language* lang;
 
-	Tokens Analyze(const String& filename);
+	Tokens Analyze(SourceFile* sourceFile);
+
+	// Finds the range (first and last character) of every comment, comments are skipped during the scan and never become tokens
+	void FindComments(const String& file, List<std::pair<uint64, uint64>>& comments);
 
 	void ParseLiteral(Tokens& tokens, uint64 i);
 	void ParseStrings(Tokens& lexerResult);
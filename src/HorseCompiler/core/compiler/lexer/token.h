@@ -26,6 +26,7 @@ SOFTWARE
 
 #include <util/string.h>
 #include <core/log/log.h>
+#include <core/error/error.h>
 #include <core/compiler/sourcelocation.h>
 #include <core/compiler/language.h>
 
@@ -76,4 +77,66 @@ public:
 
 		return items[index];
 	}
+};
+
+// Token array for the parser. The array is padded with EndOfFile tokens so the parser can look a few tokens
+// past the end without a bounds check, the end of the input is a token like any other and fails to match
+// whatever the parser expected. The padding is only there while the cursor that added it is alive, cursors created
+// in the meantime share it. The list must not be modified while a cursor is using it
+class TokenCursor {
+public:
+	static constexpr uint64 NumSentinels = 4;
+
+private:
+	Tokens* list;
+	Token*  tokens;
+	uint64  size;
+	bool    padded; // The padding was added by this cursor and is removed with it
+
+public:
+	TokenCursor(Tokens& list) : list(&list), padded(false) {
+		if (list.GetSize() < NumSentinels || list.Back().type != TokenType::EndOfFile) {
+			Token sentinel;
+
+			if (list.GetSize() > 0) {
+				const Token& last = list.Back();
+
+				sentinel.loc = SourceLocation(last.loc.file, last.loc.index + last.string.length, last.loc.line, last.loc.column + last.string.length);
+			}
+
+			sentinel.string = "<end of file>";
+			sentinel.type   = TokenType::EndOfFile;
+
+			for (uint64 i = 0; i < NumSentinels; i++) {
+				list.PushBack(sentinel);
+			}
+
+			padded = true;
+		}
+
+		tokens = list.GetData();
+		size   = list.GetSize() - NumSentinels;
+	}
+
+	TokenCursor(const TokenCursor& other) = delete;
+
+	~TokenCursor() {
+		if (!padded)
+			return;
+
+		for (uint64 i = 0; i < NumSentinels; i++) {
+			list->PopBack();
+		}
+	}
+
+	TokenCursor& operator=(const TokenCursor& other) = delete;
+
+	// Number of tokens without the padding
+	uint64 GetSize() const { return size; }
+
+	Token& operator[](uint64 index) const {
+		HC_ASSERT(index < size + NumSentinels);
+
+		return tokens[index];
+	}
 };
\ No newline at end of file
@@ -0,0 +1,782 @@
+/*
+MIT License
+
+Copyright (c) 2021 Jesper
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE
+*/
+
+#include "constant.h"
+
+#include <core/error/error.h>
+#include <util/util.h>
+
+#include <charconv>
+#include <stdint.h>
+#include <string.h>
+
+ConstantValue::ConstantValue() : type(ConstantType::Int) {
+	memset(&m4, 0, sizeof(m4));
+}
+
+ConstantValue ConstantValue::Int(int32 value) {
+	ConstantValue res;
+
+	res.type = ConstantType::Int;
+	res.i    = value;
+
+	return res;
+}
+
+ConstantValue ConstantValue::Uint(uint32 value) {
+	ConstantValue res;
+
+	res.type = ConstantType::Uint;
+	res.u    = value;
+
+	return res;
+}
+
+ConstantValue ConstantValue::Float(float value) {
+	ConstantValue res;
+
+	res.type = ConstantType::Float;
+	res.f    = value;
+
+	return res;
+}
+
+ConstantValue ConstantValue::Vec2(const vec2& value) {
+	ConstantValue res;
+
+	res.type = ConstantType::Vec2;
+	res.v2   = value;
+
+	return res;
+}
+
+ConstantValue ConstantValue::Vec3(const vec3& value) {
+	ConstantValue res;
+
+	res.type = ConstantType::Vec3;
+	res.v3   = value;
+
+	return res;
+}
+
+ConstantValue ConstantValue::Vec4(const vec4& value) {
+	ConstantValue res;
+
+	res.type = ConstantType::Vec4;
+	res.v4   = value;
+
+	return res;
+}
+
+ConstantValue ConstantValue::Mat4(const mat4& value) {
+	ConstantValue res;
+
+	res.type = ConstantType::Mat4;
+	res.m4   = value;
+
+	return res;
+}
+
+uint64 ConstantValue::FromLiteral(const String& literal, PrimitiveType type, ConstantValue* value) {
+	const char* start = literal.str;
+	const char* end   = literal.str + literal.length;
+
+	if (type == PrimitiveType::Float) {
+		float f = 0;
+
+		auto [ptr, err] = std::from_chars(start, end, f);
+
+		if (err == std::errc::result_out_of_range)
+			return HC_ERROR_SYNTAX_LITERAL_OUT_OF_RANGE;
+
+		if (err != std::errc() || (ptr != end && !(ptr + 1 == end && (*ptr == 'f' || *ptr == 'F'))))
+			return HC_ERROR_SYNTAX_INVALID_LITERAL;
+
+		*value = Float(f);
+
+		return 0;
+	}
+
+	if (type == PrimitiveType::Byte) {
+		if (literal.length != 1)
+			return HC_ERROR_SYNTAX_INVALID_LITERAL;
+
+		*value = Int((uint8)start[0]);
+
+		return 0;
+	} else if (type != PrimitiveType::Int) {
+		return HC_ERROR_SYNTAX_INVALID_LITERAL;
+	}
+
+	int  base       = 10;
+	bool isUnsigned = false;
+
+	if (literal.length > 2 && start[0] == '0' && (start[1] == 'x' || start[1] == 'X')) {
+		base = 16;
+		start += 2;
+	}
+
+	if (end > start && (end[-1] == 'u' || end[-1] == 'U')) {
+		isUnsigned = true;
+		end--;
+	}
+
+	uint64 v = 0;
+
+	auto [ptr, err] = std::from_chars(start, end, v, base);
+
+	if (err == std::errc::result_out_of_range)
+		return HC_ERROR_SYNTAX_LITERAL_OUT_OF_RANGE;
+
+	if (err != std::errc() || ptr != end)
+		return HC_ERROR_SYNTAX_INVALID_LITERAL;
+
+	// Hex literals may use all 32 bits even when they're signed
+	if (v > (isUnsigned || base == 16 ? 0xFFFFFFFFull : 0x7FFFFFFFull))
+		return HC_ERROR_SYNTAX_LITERAL_OUT_OF_RANGE;
+
+	*value = isUnsigned ? Uint((uint32)v) : Int((int32)(uint32)v);
+
+	return 0;
+}
+
+uint64 ConstantValue::GetSize() const {
+	switch (type) {
+		case ConstantType::Vec2:
+			return sizeof(vec2);
+		case ConstantType::Vec3:
+			return sizeof(vec3);
+		case ConstantType::Vec4:
+			return sizeof(vec4);
+		case ConstantType::Mat4:
+			return sizeof(mat4);
+	}
+
+	return sizeof(uint32);
+}
+
+uint64 ConstantValue::GetNumComponents() const {
+	return type == ConstantType::Mat4 ? 16 : GetSize() / sizeof(float);
+}
+
+PrimitiveType ConstantValue::GetPrimitiveType() const {
+	switch (type) {
+		case ConstantType::Float:
+			return PrimitiveType::Float;
+		case ConstantType::Vec2:
+			return PrimitiveType::Vec2;
+		case ConstantType::Vec3:
+			return PrimitiveType::Vec3;
+		case ConstantType::Vec4:
+			return PrimitiveType::Vec4;
+		case ConstantType::Mat4:
+			return PrimitiveType::Mat4;
+	}
+
+	return PrimitiveType::Int;
+}
+
+const char* ConstantValue::GetTypeName() const {
+	switch (type) {
+		case ConstantType::Int:
+			return "int";
+		case ConstantType::Uint:
+			return "unsigned int";
+		case ConstantType::Float:
+			return "float";
+		case ConstantType::Vec2:
+			return "vec2";
+		case ConstantType::Vec3:
+			return "vec3";
+		case ConstantType::Vec4:
+			return "vec4";
+		case ConstantType::Mat4:
+			return "mat4";
+	}
+
+	return "";
+}
+
+bool ConstantValue::operator==(const ConstantValue& other) const {
+	return type == other.type && memcmp(&m4, &other.m4, GetSize()) == 0;
+}
+
+uint64 ConstantValue::Hash() const {
+	return HashUtils::FNV1a(&m4, GetSize(), HashUtils::FNV1a(&type, sizeof(type)));
+}
+
+uint32 ConstantPool::Add(const ConstantValue& value) {
+	auto it = ids.find(value);
+
+	if (it != ids.end())
+		return it->second;
+
+	uint32 id = (uint32)values.GetSize();
+
+	values.PushBack(value);
+	ids.emplace(value, id);
+
+	return id;
+}
+
+static float ToFloat(const ConstantValue& value) {
+	switch (value.type) {
+		case ConstantType::Int:
+			return (float)value.i;
+		case ConstantType::Uint:
+			return (float)value.u;
+	}
+
+	return value.f;
+}
+
+// Float to int conversions saturate and NaN becomes 0, C leaves out of range values undefined
+static int32 ToInt(float value) {
+	if (!(value == value))
+		return 0;
+
+	if (value <= -2147483648.0f)
+		return INT32_MIN;
+
+	if (value >= 2147483648.0f)
+		return INT32_MAX;
+
+	return (int32)value;
+}
+
+static uint32 ToUint(float value) {
+	if (!(value > 0.0f))
+		return 0;
+
+	if (value >= 4294967296.0f)
+		return UINT32_MAX;
+
+	return (uint32)value;
+}
+
+// Writes the components of value as floats, returns the number of components
+static uint64 GetComponents(const ConstantValue& value, float* components) {
+	switch (value.type) {
+		case ConstantType::Vec2:
+		case ConstantType::Vec3:
+		case ConstantType::Vec4:
+			memcpy(components, &value.v4, value.GetSize());
+			return value.GetNumComponents();
+		case ConstantType::Mat4:
+			memcpy(components, &value.m4, sizeof(mat4));
+			return 16;
+	}
+
+	components[0] = ToFloat(value);
+
+	return 1;
+}
+
+template <typename T>
+static T GetVector(const ConstantValue& value, const T& vector) {
+	return value.IsScalar() ? T(ToFloat(value)) : vector;
+}
+
+template <typename T>
+static T VectorArithmetic(OperatorType op, const T& left, const T& right) {
+	switch (op) {
+		case OperatorType::OpAdd:
+			return left + right;
+		case OperatorType::OpSub:
+			return left - right;
+		case OperatorType::OpMul:
+			return left * right;
+	}
+
+	return left / right;
+}
+
+static uint64 EvaluateScalar(OperatorType op, const ConstantValue& left, const ConstantValue& right, ConstantValue* result) {
+	if (left.type == ConstantType::Float || right.type == ConstantType::Float) {
+		float a = ToFloat(left);
+		float b = ToFloat(right);
+
+		switch (op) {
+			case OperatorType::OpAdd:
+				*result = ConstantValue::Float(a + b);
+				return 0;
+			case OperatorType::OpSub:
+				*result = ConstantValue::Float(a - b);
+				return 0;
+			case OperatorType::OpMul:
+				*result = ConstantValue::Float(a * b);
+				return 0;
+			case OperatorType::OpDiv:
+				*result = ConstantValue::Float(a / b);
+				return 0;
+			case OperatorType::OpEqual:
+				*result = ConstantValue::Int(a == b);
+				return 0;
+			case OperatorType::OpNotEqual:
+				*result = ConstantValue::Int(a != b);
+				return 0;
+			case OperatorType::OpLess:
+				*result = ConstantValue::Int(a < b);
+				return 0;
+			case OperatorType::OpGreater:
+				*result = ConstantValue::Int(a > b);
+				return 0;
+			case OperatorType::OpLessEq:
+				*result = ConstantValue::Int(a <= b);
+				return 0;
+			case OperatorType::OpGreaterEq:
+				*result = ConstantValue::Int(a >= b);
+				return 0;
+		}
+
+		return HC_ERROR_SEMANTIC_INVALID_OPERANDS;
+	}
+
+	// Both are computed on the unsigned bit patterns so overflow wraps around instead of being undefined
+	bool   isSigned = left.type == ConstantType::Int && right.type == ConstantType::Int;
+	uint32 a        = left.u;
+	uint32 b        = right.u;
+	uint32 bits     = 0;
+
+	switch (op) {
+		case OperatorType::OpAdd:
+			bits = a + b;
+			break;
+		case OperatorType::OpSub:
+			bits = a - b;
+			break;
+		case OperatorType::OpMul:
+			bits = a * b;
+			break;
+		case OperatorType::OpDiv:
+			if (b == 0)
+				return HC_ERROR_SEMANTIC_DIVISION_BY_ZERO;
+
+			if (!isSigned) {
+				bits = a / b;
+			} else if (left.i == INT32_MIN && right.i == -1) {
+				bits = a;
+			} else {
+				bits = (uint32)(left.i / right.i);
+			}
+			break;
+		case OperatorType::OpBitAnd:
+			bits = a & b;
+			break;
+		case OperatorType::OpBitOr:
+			bits = a | b;
+			break;
+		case OperatorType::OpBitXor:
+			bits = a ^ b;
+			break;
+		case OperatorType::OpEqual:
+			*result = ConstantValue::Int(a == b);
+			return 0;
+		case OperatorType::OpNotEqual:
+			*result = ConstantValue::Int(a != b);
+			return 0;
+		case OperatorType::OpLess:
+			*result = ConstantValue::Int(isSigned ? left.i < right.i : a < b);
+			return 0;
+		case OperatorType::OpGreater:
+			*result = ConstantValue::Int(isSigned ? left.i > right.i : a > b);
+			return 0;
+		case OperatorType::OpLessEq:
+			*result = ConstantValue::Int(isSigned ? left.i <= right.i : a <= b);
+			return 0;
+		case OperatorType::OpGreaterEq:
+			*result = ConstantValue::Int(isSigned ? left.i >= right.i : a >= b);
+			return 0;
+		default:
+			return HC_ERROR_SEMANTIC_INVALID_OPERANDS;
+	}
+
+	*result = isSigned ? ConstantValue::Int((int32)bits) : ConstantValue::Uint(bits);
+
+	return 0;
+}
+
+static uint64 EvaluateShift(OperatorType op, const ConstantValue& left, const ConstantValue& right, ConstantValue* result) {
+	if (!left.IsInteger() || !right.IsInteger())
+		return HC_ERROR_SEMANTIC_INVALID_OPERANDS;
+
+	if (right.type == ConstantType::Int ? right.i < 0 || right.i >= 32 : right.u >= 32)
+		return HC_ERROR_SEMANTIC_SHIFT_OUT_OF_RANGE;
+
+	uint32 count = right.u;
+
+	// The result has the type of the left operand
+	if (op == OperatorType::OpLeftShift) {
+		*result   = left;
+		result->u = left.u << count;
+	} else if (left.type == ConstantType::Int && left.i < 0) {
+		*result = ConstantValue::Int((int32)~(~left.u >> count));
+	} else {
+		*result   = left;
+		result->u = left.u >> count;
+	}
+
+	return 0;
+}
+
+static uint64 EvaluateIndex(const ConstantValue& left, const ConstantValue& right, ConstantValue* result) {
+	if (left.IsScalar() || !right.IsInteger())
+		return HC_ERROR_SEMANTIC_INVALID_OPERANDS;
+
+	uint64 size = left.type == ConstantType::Mat4 ? 4 : left.GetNumComponents();
+
+	if (right.type == ConstantType::Int ? right.i < 0 || (uint64)right.i >= size : right.u >= size)
+		return HC_ERROR_SEMANTIC_INDEX_OUT_OF_RANGE;
+
+	if (left.type == ConstantType::Mat4) {
+		*result = ConstantValue::Vec4(left.m4[right.u]);
+	} else {
+		*result = ConstantValue::Float(left.v4[right.u]);
+	}
+
+	return 0;
+}
+
+static uint64 EvaluateMatrix(OperatorType op, const ConstantValue& left, const ConstantValue& right, ConstantValue* result) {
+	if (left.type == ConstantType::Mat4 && right.type == ConstantType::Mat4) {
+		if (op == OperatorType::OpAdd) {
+			*result = ConstantValue::Mat4(left.m4 + right.m4);
+		} else if (op == OperatorType::OpSub) {
+			*result = ConstantValue::Mat4(left.m4 - right.m4);
+		} else if (op == OperatorType::OpMul) {
+			*result = ConstantValue::Mat4(left.m4 * right.m4);
+		} else {
+			return HC_ERROR_SEMANTIC_INVALID_OPERANDS;
+		}
+	} else if (op != OperatorType::OpMul && op != OperatorType::OpDiv) {
+		return HC_ERROR_SEMANTIC_INVALID_OPERANDS;
+	} else if (left.type == ConstantType::Mat4 && right.type == ConstantType::Vec4 && op == OperatorType::OpMul) {
+		*result = ConstantValue::Vec4(left.m4 * right.v4);
+	} else if (left.type == ConstantType::Vec4 && right.type == ConstantType::Mat4 && op == OperatorType::OpMul) {
+		*result = ConstantValue::Vec4(left.v4 * right.m4);
+	} else if (left.type == ConstantType::Mat4 && right.IsScalar()) {
+		*result = ConstantValue::Mat4(op == OperatorType::OpMul ? left.m4 * ToFloat(right) : left.m4 / ToFloat(right));
+	} else if (right.type == ConstantType::Mat4 && left.IsScalar() && op == OperatorType::OpMul) {
+		*result = ConstantValue::Mat4(ToFloat(left) * right.m4);
+	} else {
+		return HC_ERROR_SEMANTIC_INVALID_OPERANDS;
+	}
+
+	return 0;
+}
+
+static uint64 EvaluateVector(OperatorType op, const ConstantValue& left, const ConstantValue& right, ConstantValue* result) {
+	ConstantType type = left.IsScalar() ? right.type : left.type;
+
+	if (!left.IsScalar() && !right.IsScalar() && left.type != right.type)
+		return HC_ERROR_SEMANTIC_INVALID_OPERANDS;
+
+	bool compare = op == OperatorType::OpEqual || op == OperatorType::OpNotEqual;
+
+	if (compare) {
+		// Only whole vectors of the same type compare, the result is a single int
+		if (left.type != right.type)
+			return HC_ERROR_SEMANTIC_INVALID_OPERANDS;
+
+		bool equal = false;
+
+		switch (type) {
+			case ConstantType::Vec2:
+				equal = left.v2 == right.v2;
+				break;
+			case ConstantType::Vec3:
+				equal = left.v3 == right.v3;
+				break;
+			case ConstantType::Vec4:
+				equal = left.v4 == right.v4;
+				break;
+		}
+
+		*result = ConstantValue::Int(op == OperatorType::OpEqual ? equal : !equal);
+
+		return 0;
+	}
+
+	if (op != OperatorType::OpAdd && op != OperatorType::OpSub && op != OperatorType::OpMul && op != OperatorType::OpDiv)
+		return HC_ERROR_SEMANTIC_INVALID_OPERANDS;
+
+	switch (type) {
+		case ConstantType::Vec2:
+			*result = ConstantValue::Vec2(VectorArithmetic(op, GetVector(left, left.v2), GetVector(right, right.v2)));
+			break;
+		case ConstantType::Vec3:
+			*result = ConstantValue::Vec3(VectorArithmetic(op, GetVector(left, left.v3), GetVector(right, right.v3)));
+			break;
+		case ConstantType::Vec4:
+			*result = ConstantValue::Vec4(VectorArithmetic(op, GetVector(left, left.v4), GetVector(right, right.v4)));
+			break;
+	}
+
+	return 0;
+}
+
+uint64 ConstantValue::Evaluate(OperatorType op, const ConstantValue& left, const ConstantValue& right, ConstantValue* result) {
+	switch (op) {
+		case OperatorType::OpSqBracketOpen:
+			return EvaluateIndex(left, right, result);
+		case OperatorType::OpLeftShift:
+		case OperatorType::OpRightShift:
+			return EvaluateShift(op, left, right, result);
+		case OperatorType::OpAnd:
+		case OperatorType::OpOr:
+			if (!left.IsScalar() || !right.IsScalar())
+				return HC_ERROR_SEMANTIC_INVALID_OPERANDS;
+
+			*result = Int(op == OperatorType::OpAnd ? left.IsTrue() && right.IsTrue() : left.IsTrue() || right.IsTrue());
+
+			return 0;
+	}
+
+	if (left.IsScalar() && right.IsScalar())
+		return EvaluateScalar(op, left, right, result);
+
+	if (left.type == ConstantType::Mat4 && right.type == ConstantType::Mat4 && op == OperatorType::OpEqual) {
+		*result = Int(left.m4 == right.m4);
+		return 0;
+	} else if (left.type == ConstantType::Mat4 && right.type == ConstantType::Mat4 && op == OperatorType::OpNotEqual) {
+		*result = Int(left.m4 != right.m4);
+		return 0;
+	} else if (left.type == ConstantType::Mat4 || right.type == ConstantType::Mat4) {
+		return EvaluateMatrix(op, left, right, result);
+	}
+
+	return EvaluateVector(op, left, right, result);
+}
+
+uint64 ConstantValue::Evaluate(OperatorType op, const ConstantValue& operand, ConstantValue* result) {
+	switch (op) {
+		case OperatorType::OpNegate:
+			switch (operand.type) {
+				case ConstantType::Int:
+				case ConstantType::Uint:
+					*result   = operand;
+					result->u = 0u - operand.u;
+					break;
+				case ConstantType::Float:
+					*result = Float(-operand.f);
+					break;
+				case ConstantType::Vec2:
+					*result = Vec2(-operand.v2);
+					break;
+				case ConstantType::Vec3:
+					*result = Vec3(-operand.v3);
+					break;
+				case ConstantType::Vec4:
+					*result = Vec4(-operand.v4);
+					break;
+				case ConstantType::Mat4:
+					*result = Mat4(-operand.m4);
+					break;
+			}
+
+			return 0;
+		case OperatorType::OpBitNot:
+			if (!operand.IsInteger())
+				return HC_ERROR_SEMANTIC_INVALID_OPERAND;
+
+			*result   = operand;
+			result->u = ~operand.u;
+
+			return 0;
+		case OperatorType::OpNot:
+			if (!operand.IsScalar())
+				return HC_ERROR_SEMANTIC_INVALID_OPERAND;
+
+			*result = Int(!operand.IsTrue());
+
+			return 0;
+	}
+
+	// Increments and decrements need a variable
+	return HC_ERROR_SEMANTIC_INVALID_OPERAND;
+}
+
+uint64 ConstantValue::Construct(PrimitiveType type, const ConstantValue* args, uint64 numArgs, ConstantValue* result) {
+	if (numArgs == 0)
+		return HC_ERROR_SEMANTIC_INVALID_CONSTRUCTOR;
+
+	if (type == PrimitiveType::Int || type == PrimitiveType::Float) {
+		if (numArgs != 1 || !args[0].IsScalar())
+			return HC_ERROR_SEMANTIC_INVALID_CONSTRUCTOR;
+
+		if (type == PrimitiveType::Float) {
+			*result = Float(ToFloat(args[0]));
+		} else {
+			*result = Int(args[0].type == ConstantType::Float ? ToInt(args[0].f) : args[0].i);
+		}
+
+		return 0;
+	}
+
+	uint64 size = 0;
+
+	switch (type) {
+		case PrimitiveType::Vec2:
+			size = 2;
+			break;
+		case PrimitiveType::Vec3:
+			size = 3;
+			break;
+		case PrimitiveType::Vec4:
+			size = 4;
+			break;
+		case PrimitiveType::Mat4:
+			size = 16;
+			break;
+		default:
+			return HC_ERROR_SEMANTIC_INVALID_CONSTRUCTOR;
+	}
+
+	ConstantValue res;
+
+	if (numArgs == 1 && args[0].IsScalar()) {
+		float s = ToFloat(args[0]);
+
+		// A single scalar fills a vector and the diagonal of a matrix
+		if (type == PrimitiveType::Mat4) {
+			res = Mat4(mat4(s));
+		} else {
+			res = Vec4(vec4(s));
+		}
+	} else if (numArgs == 1 && args[0].type == ConstantType::Mat4) {
+		if (type != PrimitiveType::Mat4)
+			return HC_ERROR_SEMANTIC_INVALID_CONSTRUCTOR;
+
+		res = args[0];
+	} else {
+		float  components[16];
+		uint64 numComponents = 0;
+
+		for (uint64 i = 0; i < numArgs; i++) {
+			if (args[i].type == ConstantType::Mat4 || numComponents + args[i].GetNumComponents() > size)
+				return HC_ERROR_SEMANTIC_INVALID_CONSTRUCTOR;
+
+			numComponents += GetComponents(args[i], components + numComponents);
+		}
+
+		if (numComponents != size)
+			return HC_ERROR_SEMANTIC_INVALID_CONSTRUCTOR;
+
+		memcpy(&res.m4, components, size * sizeof(float));
+	}
+
+	switch (type) {
+		case PrimitiveType::Vec2:
+			res.type = ConstantType::Vec2;
+			break;
+		case PrimitiveType::Vec3:
+			res.type = ConstantType::Vec3;
+			break;
+		case PrimitiveType::Vec4:
+			res.type = ConstantType::Vec4;
+			break;
+		case PrimitiveType::Mat4:
+			res.type = ConstantType::Mat4;
+			break;
+	}
+
+	// Unused components stay zero so equal values hash the same
+	memset((float*)&res.m4 + size, 0, sizeof(mat4) - size * sizeof(float));
+
+	*result = res;
+
+	return 0;
+}
+
+uint64 ConstantValue::Swizzle(const String& components, ConstantValue* result) const {
+	static const char* sets[] = { "xyzw", "rgba", "stpq" };
+
+	if (IsScalar() || type == ConstantType::Mat4 || components.length == 0 || components.length > 4)
+		return HC_ERROR_SEMANTIC_INVALID_SWIZZLE;
+
+	uint64 size = GetNumComponents();
+	vec4   res(0.0f);
+
+	for (const char* set : sets) {
+		uint64 i = 0;
+
+		for (; i < components.length; i++) {
+			const char* c = strchr(set, components.str[i]);
+
+			if (c == nullptr || components.str[i] == '\0' || (uint64)(c - set) >= size)
+				break;
+
+			res[i] = v4[c - set];
+		}
+
+		if (i == 0)
+			continue;
+
+		if (i != components.length)
+			return HC_ERROR_SEMANTIC_INVALID_SWIZZLE;
+
+		switch (components.length) {
+			case 1:
+				*result = Float(res.x);
+				break;
+			case 2:
+				*result = Vec2(vec2(res.x, res.y));
+				break;
+			case 3:
+				*result = Vec3(vec3(res.x, res.y, res.z));
+				break;
+			case 4:
+				*result = Vec4(res);
+				break;
+		}
+
+		return 0;
+	}
+
+	return HC_ERROR_SEMANTIC_INVALID_SWIZZLE;
+}
+
+uint64 ConstantValue::Convert(ConstantType type, ConstantValue* result) const {
+	if (type == this->type) {
+		*result = *this;
+		return 0;
+	}
+
+	bool scalar = type == ConstantType::Int || type == ConstantType::Uint || type == ConstantType::Float;
+
+	if (!IsScalar() || !scalar)
+		return HC_ERROR_SEMANTIC_INVALID_CONVERSION;
+
+	if (type == ConstantType::Float) {
+		*result = Float(ToFloat(*this));
+	} else if (this->type == ConstantType::Float) {
+		*result = type == ConstantType::Int ? Int(ToInt(f)) : Uint(ToUint(f));
+	} else {
+		// int and unsigned int keep the bit pattern
+		*result      = *this;
+		result->type = type;
+	}
+
+	return 0;
+}
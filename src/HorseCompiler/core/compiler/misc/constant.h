@@ -0,0 +1,123 @@
+/*
+MIT License
+
+Copyright (c) 2021 Jesper
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE
+*/
+
+#pragma once
+
+#include <core/def.h>
+#include <util/string.h>
+#include <util/list.h>
+#include <core/compiler/language.h>
+#include "vec.h"
+#include "mat.h"
+
+#include <unordered_map>
+
+enum class ConstantType : uint8 {
+	Int,
+	Uint,
+	Float,
+	Vec2,
+	Vec3,
+	Vec4,
+	Mat4
+};
+
+// A constant value stored inline, type selects the active member
+struct ConstantValue {
+	ConstantType type;
+
+	union {
+		int32  i;
+		uint32 u;
+		float  f;
+		vec2   v2;
+		vec3   v3;
+		vec4   v4;
+		mat4   m4;
+	};
+
+	ConstantValue();
+
+	static ConstantValue Int(int32 value);
+	static ConstantValue Uint(uint32 value);
+	static ConstantValue Float(float value);
+	static ConstantValue Vec2(const vec2& value);
+	static ConstantValue Vec3(const vec3& value);
+	static ConstantValue Vec4(const vec4& value);
+	static ConstantValue Mat4(const mat4& value);
+
+	// Parses an int ("10", "0x1F", "10u"), float ("1.5", "1.5f") or character literal, returns the error code on failure and 0 on success
+	static uint64 FromLiteral(const String& literal, PrimitiveType type, ConstantValue* value);
+
+	uint64        GetSize() const; // Size in bytes of the active member
+	uint64        GetNumComponents() const; // 1 for scalars
+	PrimitiveType GetPrimitiveType() const;
+	const char*   GetTypeName() const;
+
+	bool IsScalar() const { return type == ConstantType::Int || type == ConstantType::Uint || type == ConstantType::Float; }
+	bool IsInteger() const { return type == ConstantType::Int || type == ConstantType::Uint; }
+	bool IsTrue() const { return type == ConstantType::Float ? f != 0.0f : u != 0; } // Scalars only
+
+	/* Constant folding, all return the error code on failure and 0 on success.
+	*
+	* Integers follow C: int and unsigned int mix as unsigned, arithmetic wraps around (INT_MIN / -1 is INT_MIN),
+	* right shifts of negative ints are arithmetic and the shift count must be in [0, 31]. Comparisons and
+	* logical operators give an int 0 or 1. Floats follow IEEE 754, scalars are broadcast to vectors and
+	* mat4 * mat4/vec4 is the linear algebra product.
+	*/
+	static uint64 Evaluate(OperatorType op, const ConstantValue& left, const ConstantValue& right, ConstantValue* result);
+	static uint64 Evaluate(OperatorType op, const ConstantValue& operand, ConstantValue* result);
+	// int(x), float(x), vecN(...) and mat4(...), vectors take a single scalar or exactly N components, mat4 a scalar for the diagonal, a mat4 or 16 components
+	static uint64 Construct(PrimitiveType type, const ConstantValue* args, uint64 numArgs, ConstantValue* result);
+	// components is 1-4 characters from one of the sets xyzw, rgba or stpq
+	uint64 Swizzle(const String& components, ConstantValue* result) const;
+	// Implicit conversion between int, unsigned int and float, other types only convert to themselves
+	uint64 Convert(ConstantType type, ConstantValue* result) const;
+
+	// Constants are compared bit by bit, 0.0 and -0.0 are different constants
+	bool   operator==(const ConstantValue& other) const;
+	uint64 Hash() const;
+};
+
+namespace std {
+template <>
+struct hash<ConstantValue> {
+	size_t operator()(const ConstantValue& value) const { return (size_t)value.Hash(); }
+};
+} // namespace std
+
+// Deduplicated constants of a module, identical values share the same id
+class ConstantPool {
+public:
+	static constexpr uint32 Invalid = ~0u;
+
+private:
+	List<ConstantValue>                       values;
+	std::unordered_map<ConstantValue, uint32> ids;
+
+public:
+	uint32               Add(const ConstantValue& value);
+	const ConstantValue& Get(uint32 id) const { return values[id]; }
+	uint64               GetSize() const { return values.GetSize(); }
+};
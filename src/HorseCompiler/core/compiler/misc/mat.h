@@ -0,0 +1,58 @@
+/*
+MIT License
+
+Copyright (c) 2021 Jesper
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE
+*/
+
+#pragma once
+
+#include "vec.h"
+
+// Column major, columns[c][r] is row r of column c
+class mat4 {
+public:
+    vec4 columns[4];
+
+    mat4() = default;
+    mat4(float diagonal) : columns{ vec4(diagonal, 0, 0, 0), vec4(0, diagonal, 0, 0), vec4(0, 0, diagonal, 0), vec4(0, 0, 0, diagonal) } {}
+    mat4(const vec4& c0, const vec4& c1, const vec4& c2, const vec4& c3) : columns{ c0, c1, c2, c3 } {}
+
+    vec4&       operator[](uint64 column) { return columns[column]; }
+    const vec4& operator[](uint64 column) const { return columns[column]; }
+
+    mat4 operator-() const { return mat4(-columns[0], -columns[1], -columns[2], -columns[3]); }
+    mat4 operator+(const mat4& other) const { return mat4(columns[0] + other[0], columns[1] + other[1], columns[2] + other[2], columns[3] + other[3]); }
+    mat4 operator-(const mat4& other) const { return mat4(columns[0] - other[0], columns[1] - other[1], columns[2] - other[2], columns[3] - other[3]); }
+    mat4 operator*(float s) const { return mat4(columns[0] * s, columns[1] * s, columns[2] * s, columns[3] * s); }
+    mat4 operator/(float s) const { return mat4(columns[0] / s, columns[1] / s, columns[2] / s, columns[3] / s); }
+
+    // Linear algebra product, not component wise
+    vec4 operator*(const vec4& v) const { return columns[0] * v.x + columns[1] * v.y + columns[2] * v.z + columns[3] * v.w; }
+    mat4 operator*(const mat4& other) const { return mat4(*this * other[0], *this * other[1], *this * other[2], *this * other[3]); }
+
+    bool operator==(const mat4& other) const { return columns[0] == other[0] && columns[1] == other[1] && columns[2] == other[2] && columns[3] == other[3]; }
+    bool operator!=(const mat4& other) const { return !(*this == other); }
+};
+
+inline mat4 operator*(float s, const mat4& m) { return m * s; }
+
+// Row vector times matrix
+inline vec4 operator*(const vec4& v, const mat4& m) { return vec4(v.Dot(m[0]), v.Dot(m[1]), v.Dot(m[2]), v.Dot(m[3])); }
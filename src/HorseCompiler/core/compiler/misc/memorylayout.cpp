@@ -0,0 +1,166 @@
+/*
+MIT License
+
+Copyright (c) 2021 Jesper
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE
+*/
+
+#include "memorylayout.h"
+
+static uint32 AlignUp(uint32 value, uint32 alignment) {
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+// A 3 component vector is aligned like a 4 component one
+static uint32 GetVectorAlignment(uint32 componentSize, uint32 components) {
+	return componentSize * (components == 3 ? 4 : components);
+}
+
+bool MemoryLayout::GetLayout(const Type* type, LayoutRules rules, TypeLayout* layout) {
+	if (type == nullptr)
+		return false;
+
+	layout->matrixStride = 0;
+	layout->arrayStride  = 0;
+
+	switch (type->type) {
+		case Type::Scalar:
+			layout->size      = ((const TypeScalar*)type)->bits / 8;
+			layout->alignment = layout->size;
+			return true;
+		case Type::Vec: {
+			const TypeVec* vec  = (const TypeVec*)type;
+			uint32         size = vec->component->bits / 8;
+
+			layout->size      = size * vec->components;
+			layout->alignment = GetVectorAlignment(size, vec->components);
+			return true;
+		}
+		case Type::Mat: {
+			const TypeMat* mat    = (const TypeMat*)type;
+			uint32         column = GetVectorAlignment(mat->component->bits / 8, mat->rows);
+
+			// Like an array of columns, std140 rounds the stride of arrays up to a vec4
+			if (rules == LayoutRules::Std140)
+				column = AlignUp(column, 16);
+
+			layout->size         = column * mat->columns;
+			layout->alignment    = column;
+			layout->matrixStride = column;
+			return true;
+		}
+		case Type::Struct:
+			return GetStructLayout((const TypeStruct*)type, rules, layout, nullptr);
+	}
+
+	return false;
+}
+
+bool MemoryLayout::GetMemberOffsets(const TypeStruct* type, LayoutRules rules, List<uint32>* offsets) {
+	TypeLayout layout;
+
+	return GetStructLayout(type, rules, &layout, offsets);
+}
+
+bool MemoryLayout::GetPackedOrder(const TypeStruct* type, LayoutRules rules, List<uint32>* order, uint32* size) {
+	List<TypeLayout> layouts;
+	List<uint8>      placed;
+
+	for (const Type* element : type->elements) {
+		TypeLayout layout;
+
+		if (!GetLayout(element, rules, &layout))
+			return false;
+
+		layouts.PushBack(layout);
+		placed.PushBack(0);
+	}
+
+	uint32 offset    = 0;
+	uint32 alignment = 1;
+
+	// At every offset the member needing the least padding goes next. Of those the largest alignment first, so the
+	// small members are left to fill the gaps behind vec3s, then the largest and then the first declared
+	for (uint64 n = 0; n < layouts.GetSize(); n++) {
+		uint64 best        = ~0;
+		uint32 bestPadding = 0;
+
+		for (uint64 i = 0; i < layouts.GetSize(); i++) {
+			if (placed[i])
+				continue;
+
+			const TypeLayout& layout  = layouts[i];
+			uint32            padding = AlignUp(offset, layout.alignment) - offset;
+
+			if (best == ~0 || padding < bestPadding || (padding == bestPadding && (layout.alignment > layouts[best].alignment || (layout.alignment == layouts[best].alignment && layout.size > layouts[best].size)))) {
+				best        = i;
+				bestPadding = padding;
+			}
+		}
+
+		placed[best] = 1;
+		offset      += bestPadding + layouts[best].size;
+
+		if (layouts[best].alignment > alignment)
+			alignment = layouts[best].alignment;
+
+		order->PushBack((uint32)best);
+	}
+
+	if (rules == LayoutRules::Std140)
+		alignment = AlignUp(alignment, 16);
+
+	*size = AlignUp(offset, alignment);
+
+	return true;
+}
+
+bool MemoryLayout::GetStructLayout(const TypeStruct* type, LayoutRules rules, TypeLayout* layout, List<uint32>* offsets) {
+	uint32 offset    = 0;
+	uint32 alignment = 1;
+
+	for (const Type* element : type->elements) {
+		TypeLayout member;
+
+		if (!GetLayout(element, rules, &member))
+			return false;
+
+		offset = AlignUp(offset, member.alignment);
+
+		if (offsets)
+			offsets->PushBack(offset);
+
+		offset += member.size;
+
+		if (member.alignment > alignment)
+			alignment = member.alignment;
+	}
+
+	// std140 aligns structs like a vec4, the padding at the end makes the next member start at that alignment too
+	if (rules == LayoutRules::Std140)
+		alignment = AlignUp(alignment, 16);
+
+	layout->size         = AlignUp(offset, alignment);
+	layout->alignment    = alignment;
+	layout->matrixStride = 0;
+	layout->arrayStride  = 0;
+
+	return true;
+}
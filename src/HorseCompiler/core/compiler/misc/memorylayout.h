@@ -0,0 +1,63 @@
+/*
+MIT License
+
+Copyright (c) 2021 Jesper
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE
+*/
+
+#pragma once
+
+#include <core/def.h>
+#include <util/list.h>
+#include "type.h"
+
+enum class LayoutRules : uint8 {
+	Std140, // Uniform buffers, structs and matrix columns are aligned to 16 bytes
+	Std430  // Storage buffers and push constants, and uniform buffers where the device allows it
+};
+
+// Size and alignment of a type in a buffer, in bytes
+struct TypeLayout {
+	uint32 size;
+	uint32 alignment;
+	uint32 matrixStride; // Between the columns of a matrix, 0 for other types
+	uint32 arrayStride;  // Between the elements of an array, 0 for other types. The language has no arrays yet
+};
+
+/** MemoryLayout
+* Layout of types in buffers following the std140 and std430 rules of the GLSL specification (7.6.2.2).
+* Matrices are column major, a column is laid out like a vector with as many components as the matrix has rows.
+* 8 and 16 bit scalars are aligned to their size.
+*/
+class MemoryLayout {
+public:
+	// Returns false if the type can't be stored in a buffer
+	static bool GetLayout(const Type* type, LayoutRules rules, TypeLayout* layout);
+	// Offsets of the members from the start of the struct, in the order they're declared
+	static bool GetMemberOffsets(const TypeStruct* type, LayoutRules rules, List<uint32>* offsets);
+	// Member order that leaves little padding, order[i] is the index of the member to put at i and size is the size
+	// of the struct in that order. Greedy, so it isn't always the smallest possible but usually is
+	static bool GetPackedOrder(const TypeStruct* type, LayoutRules rules, List<uint32>* order, uint32* size);
+
+	static const char* GetRulesName(LayoutRules rules) { return rules == LayoutRules::Std140 ? "std140" : "std430"; }
+
+private:
+	static bool GetStructLayout(const TypeStruct* type, LayoutRules rules, TypeLayout* layout, List<uint32>* offsets);
+};
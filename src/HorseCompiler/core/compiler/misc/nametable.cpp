@@ -0,0 +1,65 @@
+/*
+MIT License
+
+Copyright (c) 2021 Jesper
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE
+*/
+#include "nametable.h"
+
+#include <core/error/error.h>
+
+std::shared_mutex                  NameTable::mutex;
+std::unordered_map<String, NameId> NameTable::ids;
+List<const String*>                NameTable::names;
+
+NameId NameTable::Add(const String& name) {
+	{
+		std::shared_lock<std::shared_mutex> lock(mutex);
+
+		auto it = ids.find(name);
+
+		if (it != ids.end())
+			return it->second;
+	}
+
+	std::unique_lock<std::shared_mutex> lock(mutex);
+
+	// Another thread may have added it between the locks
+	auto [it, added] = ids.emplace(name, (NameId)names.GetSize());
+
+	if (added)
+		names.PushBack(&it->first);
+
+	return it->second;
+}
+
+const String& NameTable::Get(NameId id) {
+	std::shared_lock<std::shared_mutex> lock(mutex);
+
+	HC_ASSERT(id < names.GetSize());
+
+	return *names[id];
+}
+
+uint64 NameTable::GetSize() {
+	std::shared_lock<std::shared_mutex> lock(mutex);
+
+	return names.GetSize();
+}
@@ -0,0 +1,52 @@
+/*
+MIT License
+
+Copyright (c) 2021 Jesper
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE
+*/
+#pragma once
+
+#include <util/string.h>
+#include <util/list.h>
+
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+typedef uint32 NameId;
+
+// Interns identifiers and file names so the AST and symbols can refer to them by a 32 bit id
+// after the tokens they came from are released. Ids are process wide, the same string always
+// gets the same id and the string returned by Get stays valid. Safe to use from multiple threads
+class NameTable {
+public:
+	static constexpr NameId Invalid = ~0u;
+
+private:
+	static std::shared_mutex                  mutex;
+	static std::unordered_map<String, NameId> ids;
+	static List<const String*>                names; // Pointers so a reference from Get survives the list growing
+
+public:
+	static NameId        Add(const String& name);
+	static const String& Get(NameId id);
+
+	static uint64 GetSize();
+};
@@ -24,51 +24,62 @@ SOFTWARE
 
 #include "symboltable.h"
 
+#include <core/error/error.h>
+
+SymbolTable::SymbolTable(const SymbolTable* outer) : outer(outer) {
+	PushScope(); // Global scope
+}
+
+void SymbolTable::PushScope(Symbol* owner) {
+	scopes.PushBack({ owner, List<NameId>() });
+}
+
+void SymbolTable::PopScope() {
+	HC_ASSERT(scopes.GetSize() > 1);
+
+	for (NameId name : scopes.Back().names) {
+		List<Binding>& stack = bindings[name];
+
+		stack.PopBack();
+
+		if (stack.GetSize() == 0)
+			bindings.erase(name);
+	}
+
+	scopes.PopBack();
+}
+
 void SymbolTable::AddSymbol(Symbol* symbol) {
-	if (currentScope == nullptr) {
+	Scope& scope = scopes.Back();
+
+	if (scope.owner == nullptr) {
 		symbols.PushBack(symbol);
 	} else {
-		currentScope->AddSymbol(symbol);
+		scope.owner->AddSymbol(symbol);
 	}
-}
 
-Symbol* SymbolTable::GetSymbol(const String& name, bool* isSameScope) {
-	if (isSameScope) {
-		*isSameScope = false;
-	}
+	bindings[symbol->name].PushBack({ symbol, GetDepth() });
+	scope.names.PushBack(symbol->name);
+}
 
-	if (currentScope) {
-		Symbol* curr = currentScope;
+Symbol* SymbolTable::GetSymbol(NameId name, bool* isSameScope) const {
+	auto it = bindings.find(name);
 
-		while (curr) {
-			List<Symbol*>& list = currentScope->symbols;
+	if (it == bindings.end()) {
+		if (isSameScope)
+			*isSameScope = false;
 
-			for (Symbol* symbol : list) {
-				if (symbol->name == name) {
-					if (symbol->parent == currentScope) {
-						if (isSameScope) {
-							*isSameScope = true;
-						}
-					}
+		return outer ? outer->GetSymbol(name) : nullptr;
+	}
 
-					return symbol;
-				}
-			}
+	const Binding& binding = it->second.Back();
 
-			curr = currentScope->parent;
-		}
-	}
+	if (isSameScope)
+		*isSameScope = binding.scope == GetDepth();
 
-	for (Symbol* symbol : symbols) {
-		if (symbol->name == name) {
-			if (symbol->parent == currentScope) {
-				if (isSameScope) {
-					*isSameScope = true;
-				}
-			}
-			return symbol;
-		}
-	}
+	return binding.symbol;
+}
 
-	return nullptr;
+Symbol* SymbolTable::GetSymbol(const String& name, bool* isSameScope) const {
+	return GetSymbol(NameTable::Add(name), isSameScope);
 }
\ No newline at end of file
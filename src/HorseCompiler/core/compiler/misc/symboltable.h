@@ -27,7 +27,10 @@ SOFTWARE
 #include <util/string.h>
 #include <util/list.h>
 #include "type.h"
-#include <core/compiler/lexer/token.h>
+#include "constant.h"
+#include <core/compiler/sourcelocation.h>
+
+#include <unordered_map>
 
 enum class SymbolType {
 	Root,
@@ -38,13 +41,15 @@ enum class SymbolType {
 
 class Symbol {
 public:
-	Token* token;
+	CompactLocation loc;
 	Symbol*    parent;
 	SymbolType type;
 
-	String name;
+	NameId name;
+
+	Symbol(SymbolType type, NameId name, const CompactLocation& loc) : loc(loc), parent(nullptr), type(type), name(name) { }
 
-	Symbol(SymbolType type, const String& name, Token* token) : token(token), parent(nullptr), type(type), name(name) { }
+	const String& GetName() const { return NameTable::Get(name); }
 
 	List<Symbol*> symbols;
 
@@ -61,18 +66,94 @@ public:
 	bool modified;
 	bool constness;
 
-	ConstantNode* initialValue;
+	uint32 initialValue; // Id in the module constant pool, ConstantPool::Invalid if not known at compile time
 
-	SymbolVariable(const String& name, Type* type, bool constness, Token* token) : Symbol(SymbolType::Variable, name, token), type(type), constness(constness), modified(false), initialValue(nullptr) { }
+	LayoutType layout; // LayoutType::Unknown unless the variable is a SymbolLayout
+
+	SymbolVariable(NameId name, Type* type, bool constness, const CompactLocation& loc) : Symbol(SymbolType::Variable, name, loc), type(type), constness(constness), modified(false), initialValue(ConstantPool::Invalid), layout(LayoutType::Unknown) { }
 };
 
+// Input, output, uniform buffer or sampler declared with layout (...), parameters that aren't given are Invalid
+class SymbolLayout : public SymbolVariable {
+public:
+	static constexpr uint32 Invalid = ~0u;
+
+	// Member of an inline block removed because the entry point doesn't use it
+	struct DroppedMember {
+		NameId name;
+		Type*  type;
+		uint32 declaredIndex;
+	};
+
+	LayoutNode* node;
+	bool        inlineBlock; // Uniform buffer declared with its members, nothing outside the block uses its struct
+	bool        dropped;     // Not used by the entry point, the declaration was removed from the tree
+
+	List<DroppedMember> droppedMembers;
+
+	uint32 binding;
+	uint32 set;
+	uint32 location;
+	uint32 component;
+
+	SymbolLayout(NameId name, Type* type, LayoutNode* node, const CompactLocation& loc) : SymbolVariable(name, type, node->type != LayoutType::Out, loc), node(node), inlineBlock(false), dropped(false), binding(Invalid), set(Invalid), location(Invalid), component(Invalid) { layout = node->type; }
+};
+
+// Every function with the same name shares one symbol, overloads are told apart by their number of parameters
+class SymbolFunction : public Symbol {
+public:
+	struct Overload {
+		ASTNode* node; // First declaration or definition
+		Type*    returnType; // nullptr for void
+		uint32   numParameters;
+	};
+
+	List<Overload> overloads;
+
+	SymbolFunction(NameId name, const CompactLocation& loc) : Symbol(SymbolType::Function, name, loc) { }
+
+	// nullptr if there's no overload taking numParameters arguments
+	const Overload* GetOverload(uint32 numParameters) const {
+		for (const Overload& overload : overloads) {
+			if (overload.numParameters == numParameters)
+				return &overload;
+		}
+
+		return nullptr;
+	}
+};
+
+// Every name maps to a stack of bindings, the innermost last, so a lookup is one hash lookup however deep
+// the scopes are nested. A scope remembers the names it bound and PopScope only undoes those
 class SymbolTable {
 private:
+	struct Binding {
+		Symbol* symbol;
+		uint32  scope;
+	};
+
+	struct Scope {
+		Symbol*      owner; // Symbol the scope belongs to, e.g a function, nullptr for the global scope
+		List<NameId> names;
+	};
+
+	std::unordered_map<NameId, List<Binding>> bindings;
+	List<Scope>                               scopes;
+
+	const SymbolTable* outer;
+
 public:
-	List<Symbol*> symbols;
+	List<Symbol*> symbols; // Global symbols, symbols in inner scopes are added to the owner
+
+	// Names that aren't bound in this table are looked up in outer, which isn't modified. Threads
+	// analyzing function bodies each have their own table on top of the shared globals
+	SymbolTable(const SymbolTable* outer = nullptr);
 
-	Symbol* currentScope = nullptr;
+	void   PushScope(Symbol* owner = nullptr);
+	void   PopScope();
+	uint32 GetDepth() const { return (uint32)scopes.GetSize() - 1; }
 
 	void    AddSymbol(Symbol* symbol);
-	Symbol* GetSymbol(const String& name, bool* isSameScope = nullptr);
+	Symbol* GetSymbol(NameId name, bool* isSameScope = nullptr) const;
+	Symbol* GetSymbol(const String& name, bool* isSameScope = nullptr) const;
 };
\ No newline at end of file
@@ -25,17 +25,66 @@ SOFTWARE
 #include "type.h"
 #include <core/compiler/compiler.h>
 
+void TypeStruct::Reorder(const List<uint32>& order, ASTNode* node) {
+	List<Type*>  reorderedElements;
+	List<NameId> reorderedNames;
+	List<uint32> reorderedIndex;
+
+	members.clear();
+
+	for (uint32 i = 0; i < order.GetSize(); i++) {
+		reorderedElements.PushBack(elements[order[i]]);
+		reorderedNames.PushBack(memberNames[order[i]]);
+		reorderedIndex.PushBack(GetDeclaredIndex(order[i]));
+		members.emplace(memberNames[order[i]], i);
+	}
+
+	elements      = reorderedElements;
+	memberNames   = reorderedNames;
+	declaredIndex = reorderedIndex;
+
+	if (node == nullptr)
+		return;
+
+	// Members of the node are (type, name) pairs after the name
+	List<ASTNode*> branches;
+
+	branches.PushBack(node->branches[0]);
+
+	for (uint32 index : order) {
+		branches.PushBack(node->branches[1 + index * 2]);
+		branches.PushBack(node->branches[2 + index * 2]);
+	}
+
+	node->branches = branches;
+}
+
+TypeTable::TypeTable() {
+	// Everything the Make functions can return is interned up front, so resolving types only reads the
+	// table and function bodies can be analyzed in parallel
+	for (PrimitiveType type : { PrimitiveType::Byte, PrimitiveType::Short, PrimitiveType::Int }) {
+		MakeTypeScalar(type, 0);
+		MakeTypeScalar(type, 1);
+	}
+
+	MakeTypeScalar(PrimitiveType::Float, 2);
+	MakeTypeVec(PrimitiveType::Vec2);
+	MakeTypeVec(PrimitiveType::Vec3);
+	MakeTypeVec(PrimitiveType::Vec4);
+	MakeTypeMat(PrimitiveType::Mat4);
+}
+
 Type* TypeTable::CreateType(ASTNode* node, bool* isConst) {
 	if (node->nodeType != ASTType::Type) {
 		//TODO: handle internal errors
 		return nullptr;
 	}
 
-	List<Token*>& tokens = ((TypeNode*)node)->tokens;
-	Token         signToken;
-	Token         constToken;
-	uint8         sign      = 2;
-	uint8         constness = 0;
+	List<TypeToken>& tokens = ((TypeNode*)node)->tokens;
+	TypeToken        signToken;
+	TypeToken        constToken;
+	uint8            sign      = 2;
+	uint8            constness = 0;
 
 	Type*         tmp  = nullptr;
 	PrimitiveType type = PrimitiveType::Unknown;
@@ -43,21 +92,21 @@ Type* TypeTable::CreateType(ASTNode* node, bool* isConst) {
 	uint64 i = 0;
 
 	for (; i < tokens.GetSize(); i++) {
-		Token& token = *tokens[i];
+		TypeToken& token = tokens[i];
 
 		if (token.type != TokenType::PrimitiveType) {
 			if (token.type == TokenType::Identifier) {
-				Type* tmptmp = GetType(token.string);
+				Type* tmptmp = GetType(token.name);
 
 				if (tmptmp == nullptr) {
 					break;
 				} else if (type != PrimitiveType::Unknown) {
-					Compiler::Log(token, HC_ERROR_SEMANTIC_TYPE_FOLLOWED_BY_TYPE, GetPrimitiveTypeString(type).str, tmp->name.str);
+					Compiler::Log(token.loc, token.name, HC_ERROR_SEMANTIC_TYPE_FOLLOWED_BY_TYPE, GetPrimitiveTypeString(type).str, tmp->name.str);
 					return nullptr;
 				}
 
 				if (tmp != nullptr) {
-					Compiler::Log(token, HC_ERROR_SEMANTIC_TYPE_FOLLOWED_BY_TYPE, tmp->name, tmptmp->name);
+					Compiler::Log(token.loc, token.name, HC_ERROR_SEMANTIC_TYPE_FOLLOWED_BY_TYPE, tmp->name.str, tmptmp->name.str);
 					return nullptr;
 				}
 
@@ -69,7 +118,7 @@ Type* TypeTable::CreateType(ASTNode* node, bool* isConst) {
 			switch (token.primitiveType) {
 				case PrimitiveType::Const:
 					if (constness) {
-						Compiler::Log(token, HC_WARN_SEMANTIC_SAME_TYPE_QUALIFIER);
+						Compiler::Log(token.loc, token.name, HC_WARN_SEMANTIC_SAME_TYPE_QUALIFIER);
 					}
 
 					constness  = 1;
@@ -77,10 +126,10 @@ Type* TypeTable::CreateType(ASTNode* node, bool* isConst) {
 					break;
 				case PrimitiveType::Unsigned:
 					if (sign == 0) {
-						Compiler::Log(token, HC_WARN_SEMANTIC_SAME_TYPE_QUALIFIER);
+						Compiler::Log(token.loc, token.name, HC_WARN_SEMANTIC_SAME_TYPE_QUALIFIER);
 						return nullptr;
 					} else if (sign == 1) {
-						Compiler::Log(token, HC_ERROR_SEMANTIC_SIGNED_UNSIGNED_EXCLUSIVE);
+						Compiler::Log(token.loc, token.name, HC_ERROR_SEMANTIC_SIGNED_UNSIGNED_EXCLUSIVE);
 						return nullptr;
 					}
 
@@ -89,10 +138,10 @@ Type* TypeTable::CreateType(ASTNode* node, bool* isConst) {
 					break;
 				case PrimitiveType::Signed:
 					if (sign == 1) {
-						Compiler::Log(token, HC_WARN_SEMANTIC_SAME_TYPE_QUALIFIER);
+						Compiler::Log(token.loc, token.name, HC_WARN_SEMANTIC_SAME_TYPE_QUALIFIER);
 						return nullptr;
 					} else if (sign == 0) {
-						Compiler::Log(token, HC_ERROR_SEMANTIC_SIGNED_UNSIGNED_EXCLUSIVE);
+						Compiler::Log(token.loc, token.name, HC_ERROR_SEMANTIC_SIGNED_UNSIGNED_EXCLUSIVE);
 						return nullptr;
 					}
 
@@ -108,7 +157,7 @@ Type* TypeTable::CreateType(ASTNode* node, bool* isConst) {
 				case PrimitiveType::Vec4:
 				case PrimitiveType::Mat4:
 					if (type != PrimitiveType::Unknown && tmp != nullptr) {
-						Compiler::Log(token, HC_ERROR_SEMANTIC_TYPE_FOLLOWED_BY_TYPE, GetPrimitiveTypeString(type).str, GetPrimitiveTypeString(token.primitiveType).str);
+						Compiler::Log(token.loc, token.name, HC_ERROR_SEMANTIC_TYPE_FOLLOWED_BY_TYPE, GetPrimitiveTypeString(type).str, GetPrimitiveTypeString(token.primitiveType).str);
 						return nullptr;
 					}
 
@@ -117,14 +166,10 @@ Type* TypeTable::CreateType(ASTNode* node, bool* isConst) {
 		}
 	}
 
-	if (isConst) {
-		*isConst = (bool)constness;
-	}
-
 	if (type != PrimitiveType::Unknown) {
 		if (type != PrimitiveType::Byte && type != PrimitiveType::Short && type != PrimitiveType::Int) {
 			if (sign != 2) {
-				Compiler::Log(signToken, HC_ERROR_SEMANTIC_SIGNED_UNSIGNED_NOT_ALLOWED_ON_TYPE, sign == 0 ? "unsigned" : "signed", GetPrimitiveTypeString(type).str);
+				Compiler::Log(signToken.loc, signToken.name, HC_ERROR_SEMANTIC_SIGNED_UNSIGNED_NOT_ALLOWED_ON_TYPE, sign == 0 ? "unsigned" : "signed", GetPrimitiveTypeString(type).str);
 				return nullptr;
 			}
 		}
@@ -145,48 +190,106 @@ Type* TypeTable::CreateType(ASTNode* node, bool* isConst) {
 				tmp = MakeTypeMat(type);
 		}
 	} else if (tmp) {
+		const String& name = tmp->name;
+
+		// Typedefs are resolved when they're declared, only the qualifiers are left to apply
 		if (tmp->type == Type::TypeDef) {
 			TypeTypeDef* def = (TypeTypeDef*)tmp;
 
-			if (constness == 1) {
-				if (def->constness == 1) {
-					Compiler::Log(constToken, HC_WARN_SEMANTIC_SAME_TYPE_QUALIFIER);
-				}
+			if (constness == 1 && def->constness) {
+				Compiler::Log(constToken.loc, constToken.name, HC_WARN_SEMANTIC_SAME_TYPE_QUALIFIER);
 			}
 
-			if (sign != 2) {
-				bool error = false;
-				if (def->actualType->type != Type::Scalar) {
-					error = true;
-				} else if (((TypeScalar*)def->actualType)->scalarType == TypeScalar::Float) {
-					error = true;
-				}
+			constness |= def->constness;
+			tmp        = def->actualType;
+		}
 
-				if (error) {
-					Compiler::Log(signToken, HC_ERROR_SEMANTIC_SIGNED_UNSIGNED_NOT_ALLOWED_ON_TYPE, def->name.str, sign == 0 ? "unsigned" : "signed");
-					return nullptr;
-				}
-			}
-		} else {
-			if (sign != 2) {
-				Compiler::Log(signToken, HC_ERROR_SEMANTIC_SIGNED_UNSIGNED_NOT_ALLOWED_ON_TYPE, tmp->name.str, sign == 0 ? "unsigned" : "signed");
+		if (sign != 2) {
+			if (tmp->type != Type::Scalar || ((TypeScalar*)tmp)->scalarType == TypeScalar::Float) {
+				Compiler::Log(signToken.loc, signToken.name, HC_ERROR_SEMANTIC_SIGNED_UNSIGNED_NOT_ALLOWED_ON_TYPE, sign == 0 ? "unsigned" : "signed", name.str);
 				return nullptr;
 			}
+
+			TypeScalar* scalar = (TypeScalar*)tmp;
+
+			tmp = MakeTypeScalar(scalar->bits == 8 ? PrimitiveType::Byte : scalar->bits == 16 ? PrimitiveType::Short : PrimitiveType::Int, sign);
 		}
 	} else {
-		Compiler::Log(*tokens[i], HC_ERROR_SYNTAX_ERROR);
+		if (i < tokens.GetSize()) {
+			Compiler::Log(tokens[i].loc, tokens[i].name, HC_ERROR_SYNTAX_ERROR);
+		} else {
+			Compiler::Log(node->loc, NameTable::Invalid, HC_ERROR_SYNTAX_ERROR);
+		}
 		return nullptr;
 	}
 
+	if (isConst) {
+		*isConst = (bool)constness;
+	}
+
 	return tmp;
 }
 
-Type* TypeTable::GetType(const String& name) {
-	return nullptr;
+TypeStruct* TypeTable::CreateStruct(ASTNode* node) {
+	StringNode* name  = (StringNode*)node->branches[0];
+	TypeStruct* strct = new TypeStruct(name->GetString());
+
+	// Members are (type, name) pairs after the name
+	for (uint64 i = 1; i + 1 < node->branches.GetSize(); i += 2) {
+		StringNode* memberName = (StringNode*)node->branches[i + 1];
+		Type*       type       = CreateType(node->branches[i], nullptr);
+
+		if (type == nullptr) {
+			delete strct;
+			return nullptr;
+		}
+
+		if (!strct->AddMember(memberName->name, type)) {
+			Compiler::Log(memberName->loc, memberName->name, HC_ERROR_SEMANTIC_SYMBOL_REDEFINITION);
+			delete strct;
+			return nullptr;
+		}
+	}
+
+	if (!AddNamed(name, strct)) {
+		delete strct;
+		return nullptr;
+	}
+
+	return strct;
+}
+
+TypeTypeDef* TypeTable::CreateTypedef(ASTNode* node) {
+	StringNode* name    = (StringNode*)node->branches[1];
+	bool        isConst = false;
+	Type*       type    = CreateType(node->branches[0], &isConst);
+
+	if (type == nullptr)
+		return nullptr;
+
+	// CreateType already followed any typedef in the declaration, so the chain is resolved once here
+	TypeTypeDef* def = new TypeTypeDef(name->GetString(), type, isConst);
+
+	if (!AddNamed(name, def)) {
+		delete def;
+		return nullptr;
+	}
+
+	return def;
+}
+
+Type* TypeTable::GetType(NameId name) const {
+	auto it = named.find(name);
+
+	return it == named.end() ? nullptr : it->second;
+}
+
+Type* TypeTable::GetType(const String& name) const {
+	return GetType(NameTable::Add(name));
 }
 
 String TypeTable::GetPrimitiveTypeString(PrimitiveType type) {
-	Language* lang = Language::Default();
+	const Language* lang = Language::Default();
 	for (uint64 i = 0; i < lang->primitiveTypes.GetSize(); i++) {
 		auto& t = lang->primitiveTypes[i];
 
@@ -198,90 +301,130 @@ String TypeTable::GetPrimitiveTypeString(PrimitiveType type) {
 }
 
 TypeScalar* TypeTable::MakeTypeScalar(PrimitiveType type, uint8 sign) {
-	String name("");
-
-	// If sign == 2 it will be set the default sign value
-	if (type != PrimitiveType::Float) {
-		if (sign == 0) {
-			name += "unsigned ";
-		} else if (sign == 1) {
-			name += "signed ";
-		}
-	}
-
-	TypeScalar* tmp = nullptr;
+	uint8 scalarType = TypeScalar::Int;
+	uint8 bits       = 0;
 
 	switch (type) {
 		case PrimitiveType::Byte:
-			tmp = new TypeScalar("char", TypeScalar::Int, 8, sign);
+			bits = 8;
 			break;
 		case PrimitiveType::Short:
-			tmp = new TypeScalar("short", TypeScalar::Int, 16, sign);
+			bits = 16;
 			break;
 		case PrimitiveType::Int:
-			tmp = new TypeScalar("int", TypeScalar::Int, 32, sign);
+			bits = 32;
 			break;
 		case PrimitiveType::Float:
-			tmp = new TypeScalar("float", TypeScalar::Float, 32, sign);
+			scalarType = TypeScalar::Float;
+			bits       = 32;
 			break;
+		default:
+			return nullptr;
 	}
 
-	for (Type* type : types) {
-		if (*type == tmp) {
-			delete tmp;
-			return (TypeScalar*)type;
-		}
+	// If sign == 2 it will be set the default sign value, integers are signed and float has no sign
+	if (scalarType == TypeScalar::Float) {
+		sign = 2;
+	} else if (sign == 2) {
+		sign = 1;
 	}
 
-	types.PushBack(tmp);
+	uint64 key = MakeKey(Type::Scalar, scalarType, bits, sign, 1, 1);
+
+	if (Type* existing = Find(key))
+		return (TypeScalar*)existing;
+
+	String name = sign == 0 ? "unsigned " : "";
+
+	name += GetPrimitiveTypeString(type);
+
+	TypeScalar* tmp = new TypeScalar(name, scalarType, bits, sign);
+
+	Add(key, tmp);
 
 	return tmp;
 }
 
 TypeVec* TypeTable::MakeTypeVec(PrimitiveType type) {
-	TypeVec* tmp = nullptr;
+	uint8 components = 0;
 
 	switch (type) {
 		case PrimitiveType::Vec2:
-			tmp = new TypeVec("vec2", MakeTypeScalar(PrimitiveType::Float, 0), 2);
+			components = 2;
 			break;
 		case PrimitiveType::Vec3:
-			tmp = new TypeVec("vec3", MakeTypeScalar(PrimitiveType::Float, 0), 3);
+			components = 3;
 			break;
 		case PrimitiveType::Vec4:
-			tmp = new TypeVec("vec4", MakeTypeScalar(PrimitiveType::Float, 0), 4);
+			components = 4;
 			break;
+		default:
+			return nullptr;
 	}
 
-	for (Type* type : types) {
-		if (*type == tmp) {
-			delete tmp;
-			return (TypeVec*)type;
-		}
-	}
+	TypeScalar* component = MakeTypeScalar(PrimitiveType::Float, 2);
+	uint64      key       = MakeKey(Type::Vec, component->scalarType, component->bits, component->sign, components, 1);
+
+	if (Type* existing = Find(key))
+		return (TypeVec*)existing;
 
-	types.PushBack(tmp);
+	TypeVec* tmp = new TypeVec(GetPrimitiveTypeString(type), component, components);
+
+	Add(key, tmp);
 
 	return tmp;
 }
 
 TypeMat* TypeTable::MakeTypeMat(PrimitiveType type) {
-	TypeMat* tmp = nullptr;
+	uint8 size = 0;
 
 	switch (type) {
 		case PrimitiveType::Mat4:
-			tmp = new TypeMat("mat4", MakeTypeScalar(PrimitiveType::Float, 0), 4, 4);
+			size = 4;
 			break;
+		default:
+			return nullptr;
 	}
 
-	for (Type* type : types) {
-		if (*type == tmp) {
-			delete tmp;
-			return (TypeMat*)type;
-		}
-	}
+	TypeScalar* component = MakeTypeScalar(PrimitiveType::Float, 2);
+	uint64      key       = MakeKey(Type::Mat, component->scalarType, component->bits, component->sign, size, size);
 
-	types.PushBack(tmp);
+	if (Type* existing = Find(key))
+		return (TypeMat*)existing;
+
+	TypeMat* tmp = new TypeMat(GetPrimitiveTypeString(type), component, size, size);
+
+	Add(key, tmp);
 
 	return tmp;
+}
+
+uint64 TypeTable::MakeKey(uint8 kind, uint8 scalarType, uint8 bits, uint8 sign, uint8 columns, uint8 rows) {
+	return (uint64)kind | ((uint64)scalarType << 8) | ((uint64)bits << 16) | ((uint64)sign << 24) | ((uint64)columns << 32) | ((uint64)rows << 40);
+}
+
+Type* TypeTable::Find(uint64 key) const {
+	auto it = interned.find(key);
+
+	return it == interned.end() ? nullptr : it->second;
+}
+
+void TypeTable::Add(uint64 key, Type* type) {
+	type->id = (uint32)types.GetSize();
+
+	types.PushBack(type);
+	interned.emplace(key, type);
+}
+
+bool TypeTable::AddNamed(const StringNode* name, Type* type) {
+	if (!named.emplace(name->name, type).second) {
+		Compiler::Log(name->loc, name->name, HC_ERROR_SEMANTIC_TYPE_REDEFINITION);
+		return false;
+	}
+
+	type->id = (uint32)types.GetSize();
+
+	types.PushBack(type);
+
+	return true;
 }
\ No newline at end of file
@@ -29,14 +29,11 @@ SOFTWARE
 #include <util/list.h>
 #include <core/compiler/parsing/ast.h>
 
-class Type {
-private:
-	friend class TypeScalar;
-	friend class TypeVec;
-	friend class TypeMat;
-	friend class TypeStruct;
-	friend class TypeTypeDef;
+#include <unordered_map>
 
+// Scalar, vector and matrix types are interned by TypeTable, structurally identical types are the same
+// object so types are compared by pointer or id
+class Type {
 public:
 	String name;
 
@@ -50,46 +47,11 @@ public:
 		Other
 	};
 
-	uint8 type;
-
-	virtual bool operator==(const Type* other) const {
-		if (type != other->type)
-			return false;
-
-		switch (type) {
-			case Type::Scalar:
-				return operator==((TypeScalar*)other);
-			case Type::Vec:
-				return operator==((TypeVec*)other);
-			case Type::Mat:
-				return operator==((TypeMat*)other);
-			case Type::Struct:
-				return operator==((TypeStruct*)other);
-			case Type::TypeDef:
-				return operator==((TypeTypeDef*)other);
-		}
-
-		return false;
-	}
-
-	virtual bool operator==(const Type& other) const {
-		return operator==(&other);
-	}
-
-	virtual bool operator==(const TypeScalar* other) const { return false; }
-	virtual bool operator==(const TypeVec* other) const { return false; }
-	virtual bool operator==(const TypeMat* other) const { return false; }
-	virtual bool operator==(const TypeStruct* other) const { return false; }
-	virtual bool operator==(const TypeTypeDef* other) const { return false; }
-
-	virtual bool operator==(const TypeScalar& other) const { return false; }
-	virtual bool operator==(const TypeVec& other) const { return false; }
-	virtual bool operator==(const TypeMat& other) const { return false; }
-	virtual bool operator==(const TypeStruct& other) const { return false; }
-	virtual bool operator==(const TypeTypeDef& other) const { return false; }
+	uint8  type;
+	uint32 id; // Index in TypeTable::types
 
 protected:
-	Type(const String& name, uint8 type) : name(name), type(type) { }
+	Type(const String& name, uint8 type) : name(name), type(type), id(~0u) { }
 };
 
 class TypeScalar : public Type {
@@ -101,17 +63,9 @@ public:
 
 	uint8 scalarType;
 	uint8 bits;
-	uint8 sign;
+	uint8 sign; // 0 unsigned, 1 signed, 2 float
 
 	TypeScalar(const String& name, uint8 type, uint8 bits, uint8 sign) : Type(name, Type::Scalar), scalarType(type), bits(bits), sign(sign) { }
-
-	bool operator==(const TypeScalar* other) const override {
-		return operator==(*other);
-	}
-
-	bool operator==(const TypeScalar& other) const override {
-		return scalarType == other.scalarType && bits == other.bits && sign == other.sign;
-	}
 };
 
 class TypeVec : public Type {
@@ -120,14 +74,6 @@ public:
 	uint8       components;
 
 	TypeVec(const String& name, TypeScalar* component, uint8 components) : Type(name, Type::Vec), component(component), components(components) { }
-
-	bool operator==(const TypeVec* other) const override {
-		return operator==(*other);
-	}
-
-	bool operator==(const TypeVec& other) const override {
-		return *component == other.component && components == other.components;
-	}
 };
 
 class TypeMat : public Type {
@@ -137,57 +83,86 @@ public:
 	uint8       rows;
 
 	TypeMat(const String& name, TypeScalar* component, uint8 columns, uint8 rows) : Type(name, Type::Mat), component(component), columns(columns), rows(rows) { }
-
-	bool operator==(const TypeMat* other) const override {
-		return operator==(*other);
-	}
-
-	bool operator==(const TypeMat& other) const override {
-		return *component == other.component && rows == other.rows && columns == other.columns;
-	}
 };
 
 class TypeStruct : public Type {
 public:
-	List<Type*> elements;
+	List<Type*>  elements;
+	List<NameId> memberNames; // Parallel to elements
+
+	std::unordered_map<NameId, uint32> members; // Member name to index in elements
 
-	TypeStruct(const String& name, const List<Type*>& elements) : Type(name, Type::Struct), elements(elements) { }
+	List<uint32> declaredIndex; // Position each member was declared at, empty unless the members were reordered
+
+	TypeStruct(const String& name) : Type(name, Type::Struct) { }
+
+	// Returns false if the struct already has a member with the name
+	bool AddMember(NameId name, Type* type) {
+		if (!members.emplace(name, (uint32)elements.GetSize()).second)
+			return false;
 
-	bool operator==(const TypeStruct* other) const override {
-		return operator==(*other);
+		elements.PushBack(type);
+		memberNames.PushBack(name);
+
+		return true;
 	}
 
-	bool operator==(const TypeStruct& other) const override {
-		return name == other.name;
+	// Index of a member in elements, ~0u if there's no such member
+	uint32 GetMember(NameId name) const {
+		auto it = members.find(name);
+
+		return it == members.end() ? ~0u : it->second;
 	}
+
+	uint32 GetDeclaredIndex(uint32 index) const { return declaredIndex.GetSize() > 0 ? declaredIndex[index] : index; }
+
+	// order[i] is the current index of the member that moves to i, members that aren't in order are removed.
+	// node is the struct node the type was created from, its members are reordered along if it's given
+	void Reorder(const List<uint32>& order, ASTNode* node = nullptr);
 };
 
 class TypeTypeDef : public Type {
 public:
-	Type* actualType;
+	Type* actualType; // Never a typedef, chains are resolved when the typedef is declared
 	bool  constness;
 
 	TypeTypeDef(const String& name, Type* type, bool constness) : Type(name, Type::TypeDef), actualType(type), constness(constness) { }
-
-	bool operator==(const TypeTypeDef* other) const override {
-		return operator==(*other);
-	}
-
-	bool operator==(const TypeTypeDef& other) const override {
-		return name == other.name;
-	}
 };
 
+// Owns every type. Scalars, vectors and matrices are interned by structure, structs and typedefs are
+// registered by name. Types can only be declared at global scope, so there's a single namespace for them.
+// Once the global declarations are in the table is only read, CreateType and GetType may then be called
+// from several threads
 class TypeTable {
+private:
+	std::unordered_map<uint64, Type*> interned; // Structural key, see MakeKey
+	std::unordered_map<NameId, Type*> named;
+
 public:
 	List<Type*> types;
 
-	Type* CreateType(ASTNode* node, bool* isConst);
-	Type* GetType(const String& name);
+	TypeTable();
+
+	// Resolves a Type node, typedefs resolve to the type they name
+	Type*        CreateType(ASTNode* node, bool* isConst);
+	TypeStruct*  CreateStruct(ASTNode* node);
+	TypeTypeDef* CreateTypedef(ASTNode* node);
+
+	// Struct or typedef with the name, nullptr if there's none
+	Type* GetType(NameId name) const;
+	Type* GetType(const String& name) const;
 
 	String GetPrimitiveTypeString(PrimitiveType type);
 
 	TypeScalar* MakeTypeScalar(PrimitiveType type, uint8 sign);
 	TypeVec*    MakeTypeVec(PrimitiveType type);
 	TypeMat*    MakeTypeMat(PrimitiveType type);
+
+private:
+	// Kind, scalar type, bits, sign and dimensions packed into one key
+	static uint64 MakeKey(uint8 kind, uint8 scalarType, uint8 bits, uint8 sign, uint8 columns, uint8 rows);
+
+	Type* Find(uint64 key) const;
+	void  Add(uint64 key, Type* type);
+	bool  AddNamed(const StringNode* name, Type* type);
 };
\ No newline at end of file
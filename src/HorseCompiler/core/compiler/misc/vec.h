@@ -24,27 +24,66 @@ SOFTWARE
 
 #pragma once
 
+#include <core/def.h>
+
+// Components are laid out like a float array so they can be indexed, comparisons follow IEEE 754
 class vec2 {
 public:
     float x;
     float y;
 
+    vec2() = default;
     vec2(float x, float y) : x(x), y(y) {}
+    explicit vec2(float s) : x(s), y(s) {}
+
+    float&       operator[](uint64 index) { return (&x)[index]; }
+    const float& operator[](uint64 index) const { return (&x)[index]; }
+
+    vec2 operator-() const { return vec2(-x, -y); }
+    vec2 operator+(const vec2& other) const { return vec2(x + other.x, y + other.y); }
+    vec2 operator-(const vec2& other) const { return vec2(x - other.x, y - other.y); }
+    vec2 operator*(const vec2& other) const { return vec2(x * other.x, y * other.y); }
+    vec2 operator/(const vec2& other) const { return vec2(x / other.x, y / other.y); }
+    vec2 operator*(float s) const { return vec2(x * s, y * s); }
+    vec2 operator/(float s) const { return vec2(x / s, y / s); }
 
+    bool operator==(const vec2& other) const { return x == other.x && y == other.y; }
+    bool operator!=(const vec2& other) const { return !(*this == other); }
 
+    float Dot(const vec2& other) const { return x * other.x + y * other.y; }
 };
 
+inline vec2 operator*(float s, const vec2& v) { return v * s; }
+
 class vec3 {
 public:
     float x;
     float y;
     float z;
 
+    vec3() = default;
     vec3(float x, float y, float z) : x(x), y(y), z(z) {}
+    explicit vec3(float s) : x(s), y(s), z(s) {}
+
+    float&       operator[](uint64 index) { return (&x)[index]; }
+    const float& operator[](uint64 index) const { return (&x)[index]; }
+
+    vec3 operator-() const { return vec3(-x, -y, -z); }
+    vec3 operator+(const vec3& other) const { return vec3(x + other.x, y + other.y, z + other.z); }
+    vec3 operator-(const vec3& other) const { return vec3(x - other.x, y - other.y, z - other.z); }
+    vec3 operator*(const vec3& other) const { return vec3(x * other.x, y * other.y, z * other.z); }
+    vec3 operator/(const vec3& other) const { return vec3(x / other.x, y / other.y, z / other.z); }
+    vec3 operator*(float s) const { return vec3(x * s, y * s, z * s); }
+    vec3 operator/(float s) const { return vec3(x / s, y / s, z / s); }
 
+    bool operator==(const vec3& other) const { return x == other.x && y == other.y && z == other.z; }
+    bool operator!=(const vec3& other) const { return !(*this == other); }
 
+    float Dot(const vec3& other) const { return x * other.x + y * other.y + z * other.z; }
 };
 
+inline vec3 operator*(float s, const vec3& v) { return v * s; }
+
 class vec4 {
 public:
     float x;
@@ -52,7 +91,25 @@ public:
     float z;
     float w;
 
+    vec4() = default;
     vec4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+    explicit vec4(float s) : x(s), y(s), z(s), w(s) {}
+
+    float&       operator[](uint64 index) { return (&x)[index]; }
+    const float& operator[](uint64 index) const { return (&x)[index]; }
+
+    vec4 operator-() const { return vec4(-x, -y, -z, -w); }
+    vec4 operator+(const vec4& other) const { return vec4(x + other.x, y + other.y, z + other.z, w + other.w); }
+    vec4 operator-(const vec4& other) const { return vec4(x - other.x, y - other.y, z - other.z, w - other.w); }
+    vec4 operator*(const vec4& other) const { return vec4(x * other.x, y * other.y, z * other.z, w * other.w); }
+    vec4 operator/(const vec4& other) const { return vec4(x / other.x, y / other.y, z / other.z, w / other.w); }
+    vec4 operator*(float s) const { return vec4(x * s, y * s, z * s, w * s); }
+    vec4 operator/(float s) const { return vec4(x / s, y / s, z / s, w / s); }
 
+    bool operator==(const vec4& other) const { return x == other.x && y == other.y && z == other.z && w == other.w; }
+    bool operator!=(const vec4& other) const { return !(*this == other); }
+
+    float Dot(const vec4& other) const { return x * other.x + y * other.y + z * other.z + w * other.w; }
+};
 
-};
\ No newline at end of file
+inline vec4 operator*(float s, const vec4& v) { return v * s; }
\ No newline at end of file
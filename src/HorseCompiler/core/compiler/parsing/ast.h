@@ -28,6 +28,8 @@ SOFTWARE
 #include <util/list.h>
 #include <core/compiler/language.h>
 #include <core/compiler/lexer/token.h>
+#include <core/compiler/misc/constant.h>
+#include <core/compiler/misc/nametable.h>
 
 enum class ASTType {
 	Unknown,
@@ -86,7 +88,9 @@ enum class ASTType {
 *       * Return type
 *       * Name
 *       * Parameters
-*       * Body
+*       * Body, the statements of the body or a single Body node if it hasn't been parsed yet
+*
+* Body: A function body that was skipped by the parser, see BodyNode
 *
 * FunctionCall:
 *   Branches:
@@ -124,6 +128,9 @@ enum class ASTType {
 *		* Parameters
 *		* Name
 *		* Struct
+*	Branches (Sampler):
+*		* Parameters
+*		* Name
 *
 * Struct: Struct definition
 *	Branches:
@@ -140,15 +147,31 @@ public:
 	ASTType annotationType;
 };
 
+// How the value of an expression may be used, set by the semantic pass along with its type
+enum class ValueCategory : uint8 {
+	Unknown,  // Not typed yet
+	LValue,   // Names a variable, or part of one, that can be assigned
+	Constant, // Known at compile time
+	Uniform,  // Not known at compile time but the same for every invocation
+	Varying   // May differ between invocations
+};
+
+// Nodes don't point to tokens, names are interned and locations are compact so the token buffer
+// can be released once parsing is done
 class ASTNode {
 public:
-	ASTNode(ASTType type) : parent(nullptr), nodeType(type), token(nullptr) { }
-	ASTNode(ASTType type, Token* token) : parent(nullptr), nodeType(type), token(token) { }
+	ASTNode(ASTType type) : parent(nullptr), nodeType(type), typeId(~0u), category(ValueCategory::Unknown) { }
+	ASTNode(ASTType type, const CompactLocation& loc) : parent(nullptr), nodeType(type), loc(loc), typeId(~0u), category(ValueCategory::Unknown) { }
 
 	ASTNode* parent;
 	ASTType  nodeType;
 
-	Token* token;
+	CompactLocation loc;
+
+	// Expressions are typed once by the semantic pass, later passes read the type from TypeTable::types
+	// instead of walking the subtree again. typeId is ~0u if the node isn't an expression or couldn't be typed
+	uint32        typeId;
+	ValueCategory category;
 
 	List<ASTNode*> branches;
 
@@ -160,35 +183,50 @@ public:
 
 class StringNode : public ASTNode {
 public:
-	String string;
+	NameId name;
 
-	StringNode(const String& string, Token* token) : ASTNode(ASTType::String, token), string(string) { }
+	StringNode(NameId name, const CompactLocation& loc) : ASTNode(ASTType::String, loc), name(name) { }
+
+	const String& GetString() const { return NameTable::Get(name); }
+};
+
+// What the type checker needs from a token in a type declaration
+struct TypeToken {
+	CompactLocation loc;
+	NameId          name          = NameTable::Invalid;
+	TokenType       type          = TokenType::Unknown;
+	PrimitiveType   primitiveType = PrimitiveType::Unknown;
 };
 
 class TypeNode : public ASTNode {
 public:
-	List<Token*> tokens;
+	List<TypeToken> tokens;
 
-	TypeNode(Token* token) : ASTNode(ASTType::Type, token) { }
+	TypeNode(const CompactLocation& loc) : ASTNode(ASTType::Type, loc) { }
 
-	void AddToken(Token* token) { tokens.PushBack(token); }
+	void AddToken(const Token& token) { tokens.PushBack({ token.loc, NameTable::Add(token.string), token.type, token.primitiveType }); }
 };
 
 class ConstantNode : public ASTNode {
 public:
-	PrimitiveType type;
+	ConstantValue value;
 
-	void* data;
+	ConstantNode(const ConstantValue& value, const CompactLocation& loc) : ASTNode(ASTType::Constant, loc), value(value) { }
+};
+
+// Token range of a function body that hasn't been parsed, Syntax::ParseBody replaces it with the statements
+class BodyNode : public ASTNode {
+public:
+	uint64 start; // First token after the '{'
 
-	ConstantNode(PrimitiveType type, uint32 value, Token* token);
-	ConstantNode(PrimitiveType type, float value, Token* token);
+	BodyNode(uint64 start, const CompactLocation& loc) : ASTNode(ASTType::Body, loc), start(start) { }
 };
 
 class OperatorNode : public ASTNode {
 public:
 	OperatorType type;
 
-	OperatorNode(OperatorType type, Token* token) : ASTNode(ASTType::Operator, token), type(type) { }
+	OperatorNode(OperatorType type, const CompactLocation& loc) : ASTNode(ASTType::Operator, loc), type(type) { }
 };
 
 enum class LayoutType {
@@ -205,7 +243,7 @@ class LayoutNode : public ASTNode {
 public:
 	LayoutType type;
 
-	LayoutNode(Token* token) : ASTNode(ASTType::Layout, token), type(LayoutType::Unknown) { }
+	LayoutNode(const CompactLocation& loc) : ASTNode(ASTType::Layout, loc), type(LayoutType::Unknown) { }
 };
 
 /*
@@ -0,0 +1,592 @@
+/*
+MIT License
+
+Copyright (c) 2021 Jesper
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE
+*/
+
+#include "astpool.h"
+
+#include <util/file.h>
+#include <util/util.h>
+
+#include <string.h>
+
+static uint64 Align(uint64 offset) {
+	return (offset + 7) & ~7ull;
+}
+
+ASTPool::ASTPool() : mapping(nullptr), mappingSize(0) {
+	UpdateViews();
+}
+
+ASTPool::~ASTPool() {
+	Unmap();
+}
+
+ASTIndex ASTPool::Flatten(const ASTNode* root) {
+	HC_ASSERT(!IsMapped());
+
+	struct Pending {
+		const ASTNode* node;
+		ASTIndex       parent;
+		uint32         slot; // Index into children where the parent expects this node
+	};
+
+	List<Pending> stack;
+
+	stack.PushBack({ root, Invalid, Invalid });
+
+	ASTIndex rootIndex = (ASTIndex)records.GetSize();
+
+	while (stack.GetSize() > 0) {
+		Pending pending = stack.Back();
+		stack.PopBack();
+
+		const ASTNode* node  = pending.node;
+		ASTIndex       index = (ASTIndex)records.GetSize();
+
+		if (pending.slot != Invalid)
+			children[pending.slot] = index;
+
+		Record record;
+
+		record.nodeType    = (uint16)node->nodeType;
+		record.extra       = 0;
+		record.parent      = pending.parent;
+		record.firstChild  = (uint32)children.GetSize();
+		record.numChildren = (uint32)node->branches.GetSize();
+		record.data        = 0;
+		record.file        = AddName(node->loc.file);
+		record.line        = node->loc.line;
+		record.column      = node->loc.column;
+
+		switch (node->nodeType) {
+			case ASTType::String:
+				record.data = AddName(((const StringNode*)node)->name);
+				break;
+			case ASTType::Type: {
+				const TypeNode* type = (const TypeNode*)node;
+
+				record.data  = (uint32)typeTokens.GetSize();
+				record.extra = (uint16)type->tokens.GetSize();
+
+				for (const TypeToken& token : type->tokens) {
+					TypeTokenRecord tokenRecord;
+
+					memset(&tokenRecord, 0, sizeof(TypeTokenRecord));
+
+					tokenRecord.name          = AddName(token.name);
+					tokenRecord.file          = AddName(token.loc.file);
+					tokenRecord.line          = token.loc.line;
+					tokenRecord.column        = token.loc.column;
+					tokenRecord.type          = (uint16)token.type;
+					tokenRecord.primitiveType = (uint8)token.primitiveType;
+
+					typeTokens.PushBack(tokenRecord);
+				}
+
+				break;
+			}
+			case ASTType::Constant: {
+				const ConstantNode* constant = (const ConstantNode*)node;
+
+				record.extra = (uint16)constant->value.type;
+				record.data  = constants.Add(constant->value);
+
+				break;
+			}
+			case ASTType::Operator:
+				record.extra = (uint16)((const OperatorNode*)node)->type;
+				break;
+			case ASTType::Layout:
+				record.extra = (uint16)((const LayoutNode*)node)->type;
+				break;
+			case ASTType::Body:
+				record.data = (uint32)((const BodyNode*)node)->start;
+				break;
+		}
+
+		records.PushBack(record);
+
+		for (uint32 i = 0; i < record.numChildren; i++) {
+			children.PushBack(Invalid);
+		}
+
+		// Pushed in reverse so the first child is stored right after its parent
+		for (uint32 i = record.numChildren; i > 0; i--) {
+			stack.PushBack({ node->branches[i - 1], index, record.firstChild + i - 1 });
+		}
+	}
+
+	UpdateViews();
+
+	return rootIndex;
+}
+
+bool ASTPool::Write(const String& filename, uint64 key, ASTIndex root) const {
+	Header header;
+
+	memset(&header, 0, sizeof(Header));
+
+	header.magic            = Magic;
+	header.version          = Version;
+	header.key              = key;
+	header.numRecords       = (uint32)numRecords;
+	header.numChildren      = (uint32)(IsMapped() ? ((const Header*)mapping)->numChildren : children.GetSize());
+	header.numTypeTokens    = (uint32)(IsMapped() ? ((const Header*)mapping)->numTypeTokens : typeTokens.GetSize());
+	header.numConstants     = (uint32)constants.GetSize();
+	header.root             = root;
+	header.recordsOffset    = Align(sizeof(Header));
+	header.childrenOffset   = Align(header.recordsOffset + sizeof(Record) * header.numRecords);
+	header.typeTokensOffset = Align(header.childrenOffset + sizeof(ASTIndex) * header.numChildren);
+	header.constantsOffset  = Align(header.typeTokensOffset + sizeof(TypeTokenRecord) * header.numTypeTokens);
+	header.stringsOffset    = Align(header.constantsOffset + sizeof(ConstantValue) * header.numConstants);
+	header.stringsSize      = IsMapped() ? ((const Header*)mapping)->stringsSize : stringData.GetSize();
+
+	uint64 size = header.stringsOffset + header.stringsSize;
+	byte*  data = new byte[size];
+
+	memset(data, 0, size);
+
+	auto Copy = [data](uint64 offset, const void* source, uint64 size) {
+		if (size > 0)
+			memcpy(data + offset, source, size);
+	};
+
+	Copy(header.recordsOffset, recordView, sizeof(Record) * header.numRecords);
+	Copy(header.childrenOffset, childView, sizeof(ASTIndex) * header.numChildren);
+	Copy(header.typeTokensOffset, typeTokenView, sizeof(TypeTokenRecord) * header.numTypeTokens);
+	Copy(header.stringsOffset, stringView, header.stringsSize);
+
+	for (uint32 i = 0; i < header.numConstants; i++) {
+		memcpy(data + header.constantsOffset + sizeof(ConstantValue) * i, &constants.Get(i), sizeof(ConstantValue));
+	}
+
+	header.checksum = HashUtils::FNV1a(data + header.recordsOffset, size - header.recordsOffset);
+
+	memcpy(data, &header, sizeof(Header));
+
+	bool res = FileUtils::WriteFile(filename, data, size);
+
+	delete[] data;
+
+	if (!res) {
+		Log::Error("failed to write ast \"%s\"", filename.str);
+	}
+
+	return res;
+}
+
+bool ASTPool::Load(const String& filename, uint64 key, ASTIndex* root) {
+	HC_ASSERT(numRecords == 0);
+
+	uint64      size = 0;
+	const byte* data = FileUtils::MapFile(filename, &size);
+
+	if (data == nullptr)
+		return false;
+
+	const Header* header = (const Header*)data;
+
+	bool valid = size >= sizeof(Header) && header->magic == Magic && header->version == Version;
+
+	valid = valid && header->recordsOffset + sizeof(Record) * header->numRecords <= size;
+	valid = valid && header->childrenOffset + sizeof(ASTIndex) * header->numChildren <= size;
+	valid = valid && header->typeTokensOffset + sizeof(TypeTokenRecord) * header->numTypeTokens <= size;
+	valid = valid && header->constantsOffset + sizeof(ConstantValue) * header->numConstants <= size;
+	valid = valid && header->stringsOffset + header->stringsSize <= size;
+	valid = valid && (header->stringsSize == 0 || data[header->stringsOffset + header->stringsSize - 1] == 0);
+	valid = valid && header->root < header->numRecords;
+	valid = valid && header->recordsOffset >= sizeof(Header) && header->recordsOffset <= size;
+
+	if (!valid) {
+		Log::Warning("\"%s\" is not a valid ast", filename.str);
+		FileUtils::UnmapFile(data, size);
+		return false;
+	}
+
+	// Corrupt records are treated like a stale file, the source is parsed again
+	if (header->key != key || header->checksum != HashUtils::FNV1a(data + header->recordsOffset, size - header->recordsOffset) || !Validate(header, data)) {
+		FileUtils::UnmapFile(data, size);
+		return false;
+	}
+
+	mapping     = data;
+	mappingSize = size;
+
+	const ConstantValue* mappedConstants = (const ConstantValue*)(data + header->constantsOffset);
+
+	for (uint32 i = 0; i < header->numConstants; i++) {
+		constants.Add(mappedConstants[i]);
+	}
+
+	UpdateViews();
+
+	*root = header->root;
+
+	return true;
+}
+
+bool ASTPool::Validate(const Header* header, const byte* data) {
+	const Record*          records    = (const Record*)(data + header->recordsOffset);
+	const ASTIndex*        children   = (const ASTIndex*)(data + header->childrenOffset);
+	const TypeTokenRecord* typeTokens = (const TypeTokenRecord*)(data + header->typeTokensOffset);
+
+	auto ValidString = [header](uint32 offset, bool optional) {
+		return (optional && offset == Invalid) || offset < header->stringsSize;
+	};
+
+	for (uint32 i = 0; i < header->numTypeTokens; i++) {
+		if (!ValidString(typeTokens[i].name, true) || !ValidString(typeTokens[i].file, true))
+			return false;
+	}
+
+	for (uint32 i = 0; i < header->numRecords; i++) {
+		const Record& record = records[i];
+
+		if (record.nodeType > (uint16)ASTType::Typedef || !ValidString(record.file, true))
+			return false;
+
+		if ((uint64)record.firstChild + record.numChildren > header->numChildren)
+			return false;
+
+		if (record.parent != Invalid && record.parent >= i)
+			return false;
+
+		switch ((ASTType)record.nodeType) {
+			case ASTType::String:
+				if (!ValidString(record.data, true))
+					return false;
+				break;
+			case ASTType::Type:
+				if ((uint64)record.data + record.extra > header->numTypeTokens)
+					return false;
+				break;
+			case ASTType::Constant:
+				if (record.data >= header->numConstants)
+					return false;
+				break;
+		}
+
+		// Children come after their parent and point back to it, so walking from the root always ends
+		for (uint32 j = 0; j < record.numChildren; j++) {
+			ASTIndex child = children[record.firstChild + j];
+
+			if (child >= header->numRecords || child <= i || records[child].parent != i)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+ASTNode* ASTPool::CreateTree(ASTIndex root) {
+	std::unordered_map<uint32, NameId> names; // String offset to interned name
+
+	auto GetName = [this, &names](uint32 offset) {
+		if (offset == Invalid)
+			return NameTable::Invalid;
+
+		auto it = names.find(offset);
+
+		if (it != names.end())
+			return it->second;
+
+		NameId name = NameTable::Add(String(stringView + offset));
+
+		names.emplace(offset, name);
+
+		return name;
+	};
+
+	List<std::pair<ASTIndex, ASTNode*>> stack;
+	ASTNode*                            result = nullptr;
+
+	stack.PushBack({ root, nullptr });
+
+	while (stack.GetSize() > 0) {
+		auto [index, parent] = stack.Back();
+		stack.PopBack();
+
+		const Record&   record = recordView[index];
+		CompactLocation loc(GetName(record.file), record.line, record.column);
+		ASTNode*        node   = nullptr;
+
+		switch ((ASTType)record.nodeType) {
+			case ASTType::String:
+				node = new StringNode(GetName(record.data), loc);
+				break;
+			case ASTType::Type: {
+				TypeNode* type = new TypeNode(loc);
+
+				for (uint32 i = 0; i < record.extra; i++) {
+					const TypeTokenRecord& tokenRecord = typeTokenView[record.data + i];
+
+					TypeToken token;
+
+					token.loc           = CompactLocation(GetName(tokenRecord.file), tokenRecord.line, tokenRecord.column);
+					token.name          = GetName(tokenRecord.name);
+					token.type          = (TokenType)tokenRecord.type;
+					token.primitiveType = (PrimitiveType)tokenRecord.primitiveType;
+
+					type->tokens.PushBack(token);
+				}
+
+				node = type;
+				break;
+			}
+			case ASTType::Constant:
+				node = new ConstantNode(constants.Get(record.data), loc);
+				break;
+			case ASTType::Operator:
+				node = new OperatorNode((OperatorType)record.extra, loc);
+				break;
+			case ASTType::Layout: {
+				LayoutNode* layout = new LayoutNode(loc);
+
+				layout->type = (LayoutType)record.extra;
+
+				node = layout;
+				break;
+			}
+			case ASTType::Body:
+				node = new BodyNode(record.data, loc);
+				break;
+			default:
+				node = new ASTNode((ASTType)record.nodeType, loc);
+				break;
+		}
+
+		if (parent) {
+			parent->AddNode(node);
+		} else {
+			result = node;
+		}
+
+		// Reversed so the children are added in order
+		for (uint32 i = record.numChildren; i > 0; i--) {
+			stack.PushBack({ childView[record.firstChild + i - 1], node });
+		}
+	}
+
+	return result;
+}
+
+uint64 ASTPool::HashTokens(const Tokens& tokens) {
+	uint64 hash = HashUtils::FNV1a(&Version, sizeof(Version));
+
+	for (const Token& token : tokens) {
+		hash = HashUtils::FNV1a(token.string.str, token.string.length, hash);
+		hash = HashUtils::FNV1a(&token.type, sizeof(token.type), hash);
+
+		// The same tokens at other positions, or in another file, give other locations in the records
+		if (token.loc.file)
+			hash = HashUtils::FNV1a(token.loc.file->filename.str, token.loc.file->filename.length + 1, hash);
+
+		hash = HashUtils::FNV1a(&token.loc.line, sizeof(token.loc.line), hash);
+		hash = HashUtils::FNV1a(&token.loc.column, sizeof(token.loc.column), hash);
+	}
+
+	return hash;
+}
+
+uint64 ASTPool::GetMemoryUsage() const {
+	uint64 size = constants.GetSize() * sizeof(ConstantValue);
+
+	if (IsMapped())
+		return size + mappingSize;
+
+	return size + records.GetSize() * sizeof(Record) + children.GetSize() * sizeof(ASTIndex) + typeTokens.GetSize() * sizeof(TypeTokenRecord) + stringData.GetSize();
+}
+
+uint64 ASTPool::GetTreeMemoryUsage(const ASTNode* root) {
+	// Bookkeeping and rounding of a typical heap allocator, paid for every node, branch list, string and constant
+	constexpr uint64 allocationOverhead = 16;
+
+	uint64 size = 0;
+
+	List<const ASTNode*> stack;
+
+	stack.PushBack(root);
+
+	while (stack.GetSize() > 0) {
+		const ASTNode* node = stack.Back();
+		stack.PopBack();
+
+		switch (node->nodeType) {
+			case ASTType::String:
+				size += sizeof(StringNode);
+				break;
+			case ASTType::Type:
+				size += sizeof(TypeNode) + ((const TypeNode*)node)->tokens.GetSize() * sizeof(TypeToken) + allocationOverhead;
+				break;
+			case ASTType::Constant:
+				size += sizeof(ConstantNode) + allocationOverhead;
+				break;
+			case ASTType::Operator:
+				size += sizeof(OperatorNode);
+				break;
+			case ASTType::Layout:
+				size += sizeof(LayoutNode);
+				break;
+			default:
+				size += sizeof(ASTNode);
+				break;
+		}
+
+		size += allocationOverhead;
+
+		if (node->branches.GetSize() > 0)
+			size += node->branches.GetSize() * sizeof(ASTNode*) + allocationOverhead;
+
+		for (const ASTNode* branch : node->branches) {
+			stack.PushBack(branch);
+		}
+	}
+
+	return size;
+}
+
+ASTIndex ASTPool::GetChild(ASTIndex node, uint32 child) const {
+	const Record& record = recordView[node];
+
+	HC_ASSERT(child < record.numChildren);
+
+	return childView[record.firstChild + child];
+}
+
+CompactLocation ASTPool::GetLocation(ASTIndex node) const {
+	const Record& record = recordView[node];
+
+	return CompactLocation(record.file == Invalid ? NameTable::Invalid : NameTable::Add(String(stringView + record.file)), record.line, record.column);
+}
+
+ASTIndex ASTPool::GetSubtreeEnd(ASTIndex node) const {
+	// The last descendant in pre order is found by following the last child
+	while (recordView[node].numChildren > 0) {
+		node = GetChild(node, recordView[node].numChildren - 1);
+	}
+
+	return node + 1;
+}
+
+const char* ASTPool::GetString(ASTIndex node) const {
+	HC_ASSERT(GetType(node) == ASTType::String);
+
+	return stringView + recordView[node].data;
+}
+
+uint32 ASTPool::GetNumTypeTokens(ASTIndex node) const {
+	HC_ASSERT(GetType(node) == ASTType::Type);
+
+	return recordView[node].extra;
+}
+
+const ASTPool::TypeTokenRecord& ASTPool::GetTypeToken(ASTIndex node, uint32 index) const {
+	HC_ASSERT(GetType(node) == ASTType::Type);
+	HC_ASSERT(index < recordView[node].extra);
+
+	return typeTokenView[recordView[node].data + index];
+}
+
+uint32 ASTPool::GetConstantId(ASTIndex node) const {
+	HC_ASSERT(GetType(node) == ASTType::Constant);
+
+	return recordView[node].data;
+}
+
+OperatorType ASTPool::GetOperator(ASTIndex node) const {
+	HC_ASSERT(GetType(node) == ASTType::Operator);
+
+	return (OperatorType)recordView[node].extra;
+}
+
+LayoutType ASTPool::GetLayoutType(ASTIndex node) const {
+	HC_ASSERT(GetType(node) == ASTType::Layout);
+
+	return (LayoutType)recordView[node].extra;
+}
+
+uint32 ASTPool::GetBodyStart(ASTIndex node) const {
+	HC_ASSERT(GetType(node) == ASTType::Body);
+
+	return recordView[node].data;
+}
+
+uint32 ASTPool::AddString(const String& string) {
+	auto it = stringOffsets.find(string);
+
+	if (it != stringOffsets.end())
+		return it->second;
+
+	uint32 offset = (uint32)stringData.GetSize();
+
+	for (uint64 i = 0; i < string.length; i++) {
+		stringData.PushBack(string[i]);
+	}
+
+	stringData.PushBack(0);
+	stringOffsets.emplace(string, offset);
+
+	return offset;
+}
+
+uint32 ASTPool::AddName(NameId name) {
+	if (name == NameTable::Invalid)
+		return Invalid;
+
+	auto it = nameOffsets.find(name);
+
+	if (it != nameOffsets.end())
+		return it->second;
+
+	uint32 offset = AddString(NameTable::Get(name));
+
+	nameOffsets.emplace(name, offset);
+
+	return offset;
+}
+
+void ASTPool::UpdateViews() {
+	if (IsMapped()) {
+		const Header* header = (const Header*)mapping;
+
+		recordView    = (const Record*)(mapping + header->recordsOffset);
+		childView     = (const ASTIndex*)(mapping + header->childrenOffset);
+		typeTokenView = (const TypeTokenRecord*)(mapping + header->typeTokensOffset);
+		stringView    = (const char*)(mapping + header->stringsOffset);
+		numRecords    = header->numRecords;
+	} else {
+		recordView    = records.GetData();
+		childView     = children.GetData();
+		typeTokenView = typeTokens.GetData();
+		stringView    = stringData.GetData();
+		numRecords    = records.GetSize();
+	}
+}
+
+void ASTPool::Unmap() {
+	if (mapping)
+		FileUtils::UnmapFile(mapping, mappingSize);
+
+	mapping     = nullptr;
+	mappingSize = 0;
+}
\ No newline at end of file
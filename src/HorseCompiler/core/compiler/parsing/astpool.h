@@ -0,0 +1,211 @@
+/*
+MIT License
+
+Copyright (c) 2021 Jesper
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE
+*/
+
+#pragma once
+
+#include "ast.h"
+
+#include <unordered_map>
+
+typedef uint32 ASTIndex;
+
+/** ASTPool
+* Flat storage of a syntax tree. Every node is a fixed size record addressed by a 32 bit index,
+* the children of a node are stored contiguously in a shared side array. Nodes are stored in pre order
+* so a subtree is the range [node, GetSubtreeEnd(node)) and can be walked without following any pointers.
+*
+* The pool is the serialization format of the syntax tree cache. No pass reads it, ASTVisitor and every pass work on
+* ASTNode trees, so a tree is flattened when it's written to the cache and rebuilt with CreateTree when it's read back.
+*
+* Record data per node type:
+*	String:   data = offset of the name in the string data
+*	Type:     data = first type token, extra = number of type tokens
+*	Constant: data = id in the constant pool, extra = constant type
+*	Operator: extra = operator type
+*	Layout:   extra = layout type
+*	Body:     data = first token of the unparsed body
+*
+* Every record carries the location of its node, the pool doesn't reference tokens so it stays valid after they're released.
+* Nothing in the tables is a pointer, so a pool can be written to disk and read back with Load. A loaded pool is read only.
+* Loading isn't free: the file is mapped, checksummed and has every index validated, and since the passes need an ASTNode
+* tree CreateTree then allocates every node again. It's a deserializer, not a free mapping: a cache hit only saves
+* running the parser, the source is still lexed and preprocessed for the key and the tree is still built node by node.
+* Constants are small and few, they're added back to the constant pool when loading so ids stay valid.
+*
+* File format, all offsets are from the start of the file and every section is 8 byte aligned:
+* Header
+* Records:   Record[numRecords]
+* Children:  ASTIndex[numChildren]
+* Types:     TypeTokenRecord[numTypeTokens]
+* Constants: ConstantValue[numConstants]
+* Strings:   char[stringsSize], every string is null terminated
+*/
+
+class ASTPool {
+public:
+	static constexpr ASTIndex Invalid = ~0u;
+	static constexpr uint32   Magic   = 0x54534148; // "HAST"
+	static constexpr uint32   Version = 4;
+
+	struct Record {
+		uint16 nodeType;
+		uint16 extra;
+		uint32 parent;
+		uint32 firstChild; // Index into the children array
+		uint32 numChildren;
+		uint32 data;
+		uint32 file; // Offset into the string data, Invalid if the node has no location
+		int32  line;
+		int32  column;
+	};
+
+	struct TypeTokenRecord {
+		uint32 name; // Offset into the string data
+		uint32 file; // Offset into the string data, Invalid if the token doesn't come from a file
+		int32  line;
+		int32  column;
+		uint16 type;
+		uint8  primitiveType;
+		uint8  reserved;
+	};
+
+	struct Header {
+		uint32 magic;
+		uint32 version;
+		uint64 key;      // Content hash of the source the tree was parsed from
+		uint64 checksum; // Hash of everything after the header
+
+		uint32 numRecords;
+		uint32 numChildren;
+		uint32 numTypeTokens;
+		uint32 numConstants;
+		uint32 root;
+
+		uint64 recordsOffset;
+		uint64 childrenOffset;
+		uint64 typeTokensOffset;
+		uint64 constantsOffset;
+		uint64 stringsOffset;
+		uint64 stringsSize;
+	};
+
+private:
+	List<Record>          records;
+	List<ASTIndex>        children;
+	List<TypeTokenRecord> typeTokens;
+	List<char>            stringData; // Null terminated strings
+	ConstantPool          constants;
+
+	std::unordered_map<String, uint32> stringOffsets; // Deduplicates strings while building
+	std::unordered_map<NameId, uint32> nameOffsets;
+
+	// Every accessor reads through these, they point either into the lists above or into a mapped file
+	const Record*          recordView;
+	const ASTIndex*        childView;
+	const TypeTokenRecord* typeTokenView;
+	const char*            stringView;
+	uint64                 numRecords;
+
+	const byte* mapping;
+	uint64      mappingSize;
+
+public:
+	ASTPool();
+	ASTPool(const ASTPool& other) = delete;
+	~ASTPool();
+
+	ASTPool& operator=(const ASTPool& other) = delete;
+
+	// Appends a tree to the pool, returns the index of its root
+	ASTIndex Flatten(const ASTNode* root);
+
+	// Writes the pool to a file, key identifies the source it was parsed from
+	bool Write(const String& filename, uint64 key, ASTIndex root) const;
+	// Maps a file written by Write, fails if it's not a valid pool or was written for a different key.
+	// The whole file is checksummed and every index in it is checked, so a truncated or corrupt file fails instead of
+	// being read out of bounds. This is linear in the size of the file
+	bool Load(const String& filename, uint64 key, ASTIndex* root);
+
+	// Builds the pointer based tree the passes work on
+	ASTNode* CreateTree(ASTIndex root);
+
+	// Key for Write/Load, hash of the preprocessed tokens a tree is parsed from and their locations,
+	// since the records store the locations diagnostics report
+	static uint64 HashTokens(const Tokens& tokens);
+
+	bool   IsMapped() const { return mapping != nullptr; }
+	uint64 GetNumNodes() const { return numRecords; }
+	uint64 GetMemoryUsage() const;
+
+	// Heap memory used by a pointer based tree, used to compare against the pool
+	static uint64 GetTreeMemoryUsage(const ASTNode* root);
+
+	ASTType         GetType(ASTIndex node) const { return (ASTType)recordView[node].nodeType; }
+	ASTIndex        GetParent(ASTIndex node) const { return recordView[node].parent; }
+	uint32          GetNumChildren(ASTIndex node) const { return recordView[node].numChildren; }
+	ASTIndex        GetChild(ASTIndex node, uint32 child) const;
+	const ASTIndex* GetChildren(ASTIndex node) const { return childView + recordView[node].firstChild; }
+	ASTIndex        GetSubtreeEnd(ASTIndex node) const;
+
+	// Location of a node, GetLocation interns the filename
+	int32           GetLine(ASTIndex node) const { return recordView[node].line; }
+	int32           GetColumn(ASTIndex node) const { return recordView[node].column; }
+	const char*     GetFilename(ASTIndex node) const { return GetPoolString(recordView[node].file); }
+	CompactLocation GetLocation(ASTIndex node) const;
+
+	// StringNode
+	const char* GetString(ASTIndex node) const;
+
+	// TypeNode
+	uint32                 GetNumTypeTokens(ASTIndex node) const;
+	const TypeTokenRecord& GetTypeToken(ASTIndex node, uint32 index) const;
+	const char*            GetTypeTokenName(const TypeTokenRecord& token) const { return GetPoolString(token.name); }
+
+	// ConstantNode
+	uint32               GetConstantId(ASTIndex node) const;
+	const ConstantValue& GetConstant(ASTIndex node) const { return constants.Get(GetConstantId(node)); }
+
+	ConstantPool* GetConstantPool() { return &constants; }
+
+	// OperatorNode
+	OperatorType GetOperator(ASTIndex node) const;
+
+	// LayoutNode
+	LayoutType GetLayoutType(ASTIndex node) const;
+
+	// BodyNode
+	uint32 GetBodyStart(ASTIndex node) const;
+
+private:
+	uint32 AddString(const String& string);
+	uint32 AddName(NameId name);
+
+	const char* GetPoolString(uint32 offset) const { return offset == Invalid ? "" : stringView + offset; }
+
+	void UpdateViews();
+	void Unmap();
+
+	// Checks that every index and offset in a mapped file is in range and that the children form a tree
+	static bool Validate(const Header* header, const byte* data);
+};
\ No newline at end of file
@@ -0,0 +1,66 @@
+/*
+MIT License
+
+Copyright (c) 2021 Jesper
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE
+*/
+
+#include "astvisitor.h"
+
+uint64 ASTVisitor::Walk(ASTNode* root) {
+	struct Pending {
+		ASTNode* node;
+		uint64   nextChild;
+	};
+
+	List<Pending> stack;
+	uint64        numVisited = 1;
+
+	if (!Enter(root)) {
+		Leave(root);
+		return numVisited;
+	}
+
+	stack.PushBack({ root, 0 });
+
+	while (stack.GetSize() > 0) {
+		Pending& top  = stack.Back();
+		ASTNode* node = top.node;
+
+		if (top.nextChild >= node->branches.GetSize()) {
+			stack.PopBack();
+			Leave(node);
+			continue;
+		}
+
+		ASTNode* child = node->branches[top.nextChild++];
+
+		numVisited++;
+
+		// top is invalid after the push
+		if (Enter(child)) {
+			stack.PushBack({ child, 0 });
+		} else {
+			Leave(child);
+		}
+	}
+
+	return numVisited;
+}
@@ -0,0 +1,45 @@
+/*
+MIT License
+
+Copyright (c) 2021 Jesper
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE
+*/
+
+#pragma once
+
+#include "ast.h"
+
+/** ASTVisitor
+* Walks a tree in pre order with an explicit stack, deep expressions can't overflow the call stack.
+* Enter is called before the children of a node and Leave after them. The children are read when the walk
+* descends into a node, so Enter may replace the children of the node it's given.
+*/
+
+class ASTVisitor {
+public:
+	virtual ~ASTVisitor() { }
+
+	// Return false to skip the children of node, Leave is still called
+	virtual bool Enter(ASTNode* node) { return true; }
+	virtual void Leave(ASTNode* node) { }
+
+	// Returns the number of nodes visited
+	uint64 Walk(ASTNode* root);
+};
@@ -24,19 +24,254 @@ SOFTWARE
 
 #include "syntax.h"
 #include <core/compiler/compiler.h>
+#include <util/util.h>
 
-uint64 Syntax::Analyze(Tokens& tokens, uint64 start, ASTNode* currentNode, Language* lang) {
-	Syntax syn(lang);
+#include <string.h>
+#include <unordered_map>
 
-	return syn.Analyze(tokens, start, currentNode);
+Syntax::Syntax(const Language* lang) : lang(lang), currentScope(0), end(~0), lazyBodies(false) {
+	memset(operatorPrecedence, 0, sizeof(operatorPrecedence));
+
+	// The language uses 1 for the operators that binds the tightest
+	for (const OperatorTypeDef& def : lang->operators) {
+		OperatorPrecedence& prec  = operatorPrecedence[(uint64)def.type];
+		uint32              power = 16 - def.precedence;
+
+		if (def.leftOperand == OperandType::None) {
+			prec.prefix = power;
+		} else if (def.rightOperand == OperandType::None) {
+			prec.postfix = power;
+		} else {
+			prec.infix         = power;
+			prec.associativity = def.associativty;
+		}
+	}
 }
 
-uint64 Syntax::Analyze(Tokens& tokens, uint64 start, ASTNode* currentNode) {
-	HC_ASSERT(currentNode != nullptr);
+uint64 Syntax::Analyze(Tokens& tokens, uint64 start, ASTNode* currentNode, const Language* lang, bool lazyBodies) {
+	Syntax      syn(lang);
+	TokenCursor cursor(tokens);
+
+	syn.end        = cursor.GetSize();
+	syn.lazyBodies = lazyBodies;
+
+	return syn.Analyze(cursor, start, currentNode);
+}
+
+uint64 Syntax::AnalyzeParallel(Tokens& tokens, ASTNode* root, const Language* lang, uint32 numThreads, bool lazyBodies) {
+	// Small chunks aren't worth a thread, every chunk should be large enough to amortize the scheduling
+	constexpr uint64 minChunkTokens = 4096;
+
+	if (numThreads == 0)
+		numThreads = ThreadUtils::GetNumThreads();
+
+	// Padded before the threads start, they share the cursor
+	TokenCursor  cursor(tokens);
+	List<uint64> declarations = FindTopLevelDeclarations(tokens);
+
+	// Consecutive declarations are grouped into chunks, a few per thread so uneven chunks even out
+	uint64 numChunks   = cursor.GetSize() / minChunkTokens;
+	uint64 chunkTokens = 0;
+
+	if (numChunks > (uint64)numThreads * 4)
+		numChunks = (uint64)numThreads * 4;
+
+	if (numThreads <= 1 || numChunks <= 1 || declarations.GetSize() <= 1)
+		return Analyze(tokens, 0, root, lang, lazyBodies);
+
+	chunkTokens = cursor.GetSize() / numChunks;
+
+	struct Chunk {
+		uint64    start;
+		uint64    end;
+		ASTNode*  root;
+		uint64    result;
+		LogBuffer log;
+
+		Chunk(uint64 start, uint64 end) : start(start), end(end), root(nullptr), result(0) { }
+	};
+
+	List<Chunk*> chunks;
+
+	for (uint64 i = 0; i < declarations.GetSize(); i++) {
+		uint64 start = declarations[i];
+
+		if (chunks.GetSize() > 0 && start - chunks.Back()->start < chunkTokens)
+			continue;
+
+		if (chunks.GetSize() > 0)
+			chunks.Back()->end = start;
+
+		chunks.PushBack(new Chunk(start, cursor.GetSize()));
+	}
+
+	ThreadUtils::ParallelFor(chunks.GetSize(), numThreads, [&](uint64 index) {
+		Chunk* chunk = chunks[index];
+		Syntax syn(lang);
+
+		syn.end        = chunk->end;
+		syn.lazyBodies = lazyBodies;
+		chunk->root    = new ASTNode(ASTType::Root);
+
+		Log::BeginCapture(&chunk->log);
+		chunk->result = syn.Analyze(cursor, chunk->start, chunk->root);
+		Log::EndCapture();
+	});
+
+	uint64 result = 0;
+
+	// Merged in source order, stopping where the sequential parser would have stopped
+	for (Chunk* chunk : chunks) {
+		if (result == 0) {
+			Log::Replay(chunk->log);
+
+			for (ASTNode* node : chunk->root->branches) {
+				root->AddNode(node);
+			}
+
+			result = chunk->result;
+		}
+
+		delete chunk->root;
+		delete chunk;
+	}
+
+	return result;
+}
+
+uint64 Syntax::ParseBody(Tokens& tokens, ASTNode* function, const Language* lang) {
+	HC_ASSERT(function->branches.GetSize() > 0 && function->branches.Back()->nodeType == ASTType::Body);
+
+	BodyNode* body = (BodyNode*)function->branches.Back();
+
+	function->branches.PopBack();
+
+	Syntax      syn(lang);
+	TokenCursor cursor(tokens);
+
+	syn.end = cursor.GetSize();
+
+	uint64 res = syn.Analyze(cursor, body->start, function);
+
+	delete body;
+
+	return res == ~0 ? ~0 : 0;
+}
+
+uint64 Syntax::ParseReachable(Tokens& tokens, ASTNode* root, const String& entryPoint, const Language* lang, uint64* numSkipped) {
+	std::unordered_map<NameId, List<ASTNode*>> functions; // Overloads share the name
+
+	for (ASTNode* node : root->branches) {
+		if (node->nodeType == ASTType::FunctionDefinition)
+			functions[((StringNode*)node->branches[1])->name].PushBack(node);
+	}
+
+	List<ASTNode*> work;
+
+	auto entry = functions.find(NameTable::Add(entryPoint));
+
+	if (entry == functions.end()) {
+		Log::Warning("entry point \"%s\" not found, every function body is parsed", entryPoint.str);
+
+		for (auto& [name, overloads] : functions) {
+			for (ASTNode* func : overloads) {
+				work.PushBack(func);
+			}
+		}
+	} else {
+		work = entry->second;
+	}
+
+	uint64 res = 0;
+
+	while (work.GetSize() > 0) {
+		ASTNode* func = work.Back();
+		work.PopBack();
+
+		if (func->branches.Back()->nodeType != ASTType::Body)
+			continue;
+
+		if (ParseBody(tokens, func, lang) == ~0) {
+			res = ~0;
+			continue;
+		}
+
+		// Every call in the body, the callee is parsed next
+		List<ASTNode*> stack;
+
+		stack.PushBack(func);
+
+		while (stack.GetSize() > 0) {
+			ASTNode* node = stack.Back();
+			stack.PopBack();
+
+			if (node->nodeType == ASTType::Function) {
+				auto called = functions.find(((StringNode*)node->branches[0])->name);
+
+				if (called != functions.end()) {
+					for (ASTNode* callee : called->second) {
+						work.PushBack(callee);
+					}
+				}
+			}
+
+			for (ASTNode* branch : node->branches) {
+				stack.PushBack(branch);
+			}
+		}
+	}
+
+	*numSkipped = 0;
+
+	for (auto& [name, overloads] : functions) {
+		for (ASTNode* func : overloads) {
+			if (func->branches.Back()->nodeType == ASTType::Body)
+				(*numSkipped)++;
+		}
+	}
+
+	return res;
+}
 
-	static uint64 currentScope = 0;
+List<uint64> Syntax::FindTopLevelDeclarations(const Tokens& tokens) {
+	List<uint64> declarations;
 
-	for (uint64 i = start; i < tokens.GetSize(); i++) {
+	uint64 depth             = 0;
+	bool   start             = true;
+	bool   endsWithSemicolon = false; // struct, layout and typedef end with a ';' even after a '}'
+
+	for (uint64 i = 0; i < tokens.GetSize(); i++) {
+		const Token& token = tokens[i];
+
+		if (token.type == TokenType::EndOfFile)
+			break;
+
+		if (start) {
+			declarations.PushBack(i);
+
+			endsWithSemicolon = token.keyword == KeywordType::Struct || token.keyword == KeywordType::Layout || token.keyword == KeywordType::Typedef;
+			start             = false;
+		}
+
+		if (token.type == TokenType::BracketOpen) {
+			depth++;
+		} else if (token.type == TokenType::BracketClose) {
+			if (depth > 0)
+				depth--;
+
+			start = depth == 0 && !endsWithSemicolon;
+		} else if (token.type == TokenType::Semicolon) {
+			start = depth == 0;
+		}
+	}
+
+	return declarations;
+}
+
+uint64 Syntax::Analyze(const TokenCursor& tokens, uint64 start, ASTNode* currentNode) {
+	HC_ASSERT(currentNode != nullptr);
+
+	for (uint64 i = start; i < end; i++) {
 		Token& t = tokens[i];
 
 		if (t.type == TokenType::Keyword) {
@@ -64,7 +299,7 @@ uint64 Syntax::Analyze(Tokens& tokens, uint64 start, ASTNode* currentNode) {
 			} else if (t.keyword == KeywordType::Switch) {
 			} else if (t.keyword == KeywordType::Return) {
 				Token&   next = tokens[i + 1];
-				ASTNode* ret  = new ASTNode(ASTType::Return, &t);
+				ASTNode* ret  = new ASTNode(ASTType::Return, t.loc);
 
 				currentNode->AddNode(ret);
 
@@ -84,8 +319,14 @@ uint64 Syntax::Analyze(Tokens& tokens, uint64 start, ASTNode* currentNode) {
 
 		} else if (t.type == TokenType::BracketClose) {
 			return i;
+		} else if (t.type == TokenType::Identifier && tokens[i + 1].type == TokenType::ParenthesisOpen) {
+			// Call where the result isn't used
+			i = ParseExpression(tokens, i, currentNode);
+
+			if (i == ~0)
+				return ~0;
 		} else {
-			TypeNode* typeNode = new TypeNode(&t);
+			TypeNode* typeNode = new TypeNode(t.loc);
 			uint64    index    = ParseTypeDeclaration(tokens, i, typeNode);
 
 			if (index == ~0)
@@ -106,12 +347,12 @@ uint64 Syntax::Analyze(Tokens& tokens, uint64 start, ASTNode* currentNode) {
 					return ~0;
 				}
 
-				StringNode* stringNode = new StringNode(nameToken.string, &nameToken);
+				StringNode* stringNode = new StringNode(NameTable::Add(nameToken.string), nameToken.loc);
 
 				const Token& next = tokens[++index];
 
 				if (next.type == TokenType::ParenthesisOpen) {
-					ASTNode* func = new ASTNode(ASTType::FunctionDeclaration, &nameToken);
+					ASTNode* func = new ASTNode(ASTType::FunctionDeclaration, nameToken.loc);
 
 					func->AddNode(typeNode);
 					func->AddNode(stringNode);
@@ -130,18 +371,26 @@ uint64 Syntax::Analyze(Tokens& tokens, uint64 start, ASTNode* currentNode) {
 
 						func->nodeType = ASTType::FunctionDefinition;
 
-						currentScope++;
+						uint64 close = lazyBodies ? FindClosingBracket(tokens, index) : ~0;
 
-						index = Analyze(tokens, index + 1, func);
+						if (close != ~0) {
+							func->AddNode(new BodyNode(index + 1, semicolonOrBracket.loc));
 
-						if (index == ~0)
-							return ~0;
+							index = close;
+						} else {
+							currentScope++;
+
+							index = Analyze(tokens, index + 1, func);
+
+							if (index == ~0)
+								return ~0;
+						}
 					}
 
 					i = index;
 
 				} else {
-					ASTNode* var = new ASTNode(ASTType::VariableDefinition, &nameToken);
+					ASTNode* var = new ASTNode(ASTType::VariableDefinition, nameToken.loc);
 
 					currentNode->AddNode(var);
 
@@ -166,9 +415,31 @@ uint64 Syntax::Analyze(Tokens& tokens, uint64 start, ASTNode* currentNode) {
 		}
 	}
 
+	// A function body ran into the end of the input
+	if (currentNode->nodeType == ASTType::FunctionDefinition) {
+		Compiler::Log(tokens[end], HC_ERROR_SYNTAX_EXPECTED, "}");
+		return ~0;
+	}
+
 	return 0;
 }
 
+uint64 Syntax::FindClosingBracket(const TokenCursor& tokens, uint64 open) const {
+	uint64 depth = 0;
+
+	for (uint64 i = open; i < end; i++) {
+		const Token& token = tokens[i];
+
+		if (token.type == TokenType::BracketOpen) {
+			depth++;
+		} else if (token.type == TokenType::BracketClose && --depth == 0) {
+			return i;
+		}
+	}
+
+	return ~0;
+}
+
 bool Syntax::CheckName(const Token& token) {
 	String name = token.string;
 
@@ -199,110 +470,56 @@ bool Syntax::CheckName(const Token& token) {
 	return true;
 }
 
-OperatorTypeDef Syntax::GetOperator(OperatorType type, OperandType left, OperandType right, bool ignoreOperands) {
-	for (OperatorTypeDef& def : lang->operators) {
-		if (def.type == type) {
-			if (left == OperandType::None && !ignoreOperands) {
-				if (def.leftOperand != OperandType::None)
-					continue;
-			} /*else if (left == OperandType::Variable) {
-				if (def.leftOperand != OperandType::Variable && def.rightOperand != OperandType::Any) continue;
-			} else if (left == OperandType::Value) {
-				if (def.leftOperand != OperandType::Value && def.leftOperand != OperandType::Any) continue;
-			}*/
-
-			if (right == OperandType::None && !ignoreOperands) {
-				if (def.rightOperand != OperandType::None)
-					continue;
-			} /*else if (right == OperandType::Variable) {
-				if (def.rightOperand != OperandType::Variable && def.rightOperand != OperandType::Any) continue;
-			} else if (right == OperandType::Value) {
-				if (def.rightOperand != OperandType::Value && def.rightOperand != OperandType::Any) continue;
-			}*/
-
-			return def;
-		}
-	}
-
-	OperatorTypeDef tmp;
-
-	tmp.leftOperand = left;
-	tmp.rightOperand = right;
-
-	return tmp;
-}
-
-OperatorTypeDef Syntax::GetOperator(List<ASTNode*>& nodes, uint64 index) {
-	HC_ASSERT(nodes[index]->nodeType == ASTType::Operator);
+ASTNode* Syntax::CreateOperandNode(const TokenCursor& tokens, uint64* index) {
+	Token&   token = tokens[*index];
+	ASTNode* node  = nullptr;
 
-	OperatorNode* node = (OperatorNode*)nodes[index];
-	OperandType left = OperandType::None;
-	OperandType right = OperandType::None;
-
-	ASTNode* operand = nullptr;
-
-	if (index > 0) {
-		operand = nodes[index - 1];
-
-		if (operand->nodeType == ASTType::Variable || operand->nodeType == ASTType::Constant || operand->nodeType == ASTType::Function) {
-			left = OperandType::Any;
-		} else if (operand->nodeType == ASTType::Operator) {
-			if (operand->branches.GetSize() > 0) {
-				left = OperandType::Any;
-			}
-		}
-	}
+	if (token.type == TokenType::Literal) {
+		ConstantValue value;
 
-	if (index < nodes.GetSize() - 1) {
-		operand = nodes[index + 1];
+		uint64 error = ConstantValue::FromLiteral(token.string, token.primitiveType, &value);
 
-		if (operand->nodeType == ASTType::Variable || operand->nodeType == ASTType::Constant || operand->nodeType == ASTType::Function) {
-			right = OperandType::Any;
-		} else if (operand->nodeType == ASTType::Operator) {
-			right = OperandType::Any;
+		if (error) {
+			Compiler::Log(token, error);
+			return nullptr;
 		}
-	}
-
-	return GetOperator(node->type, left, right, false);
-}
-
-ASTNode* Syntax::CreateOperandNode(Tokens& tokens, uint64* index) {
-	Token& token = tokens[*index];
-	ASTNode* node = nullptr;
-
-	if (token.type == TokenType::Literal) {
 
-		switch (token.primitiveType) {
-			case PrimitiveType::Int:
-				node = new ConstantNode(token.primitiveType, (uint32)atoi(token.string.str), &token);
-				break;
-			case PrimitiveType::Float:
-				node = new ConstantNode(token.primitiveType, (float)atof(token.string.str), &token);
-				break;
-		}
+		node = new ConstantNode(value, token.loc);
 	} else if (token.type == TokenType::Identifier || token.type == TokenType::PrimitiveType) {
 		Token& next = tokens[*index + 1];
 
 		if (next.type == TokenType::ParenthesisOpen) {
-			(*index)++;
+			*index += 2;
 
-			node = new ASTNode(ASTType::Function, &token);
+			node = new ASTNode(ASTType::Function, token.loc);
 
-			node->AddNode(new StringNode(token.string, &token));
+			node->AddNode(new StringNode(NameTable::Add(token.string), token.loc));
 
-			*index = ParseExpression(tokens, *index + 1, node);
+			if (tokens[*index].type != TokenType::ParenthesisClose) {
+				*index = ParseExpression(tokens, *index, node);
+
+				if (*index == ~0)
+					return nullptr;
+			}
 
 		} else {
-			node = new ASTNode(ASTType::Variable, &token);
-			node->AddNode(new StringNode(token.string, &token));
+			node = new ASTNode(ASTType::Variable, token.loc);
+			node->AddNode(new StringNode(NameTable::Add(token.string), token.loc));
 		}
 	}
 
+	if (node == nullptr) {
+		Compiler::Log(token, HC_ERROR_SYNTAX_ERROR);
+		return nullptr;
+	}
+
+	(*index)++;
+
 	return node;
 }
 
-uint64 Syntax::ParseTypedef(Tokens& tokens, uint64 start, ASTNode* currentNode) {
-	TypeNode* type  = new TypeNode(&tokens[start]);
+uint64 Syntax::ParseTypedef(const TokenCursor& tokens, uint64 start, ASTNode* currentNode) {
+	TypeNode* type  = new TypeNode(tokens[start].loc);
 	uint64    index = ParseTypeDeclaration(tokens, start, type);
 
 	if (index == ~0)
@@ -310,8 +527,8 @@ uint64 Syntax::ParseTypedef(Tokens& tokens, uint64 start, ASTNode* currentNode)
 
 	Token&      name       = tokens[index++];
 	Token&      semiColon  = tokens[index];
-	ASTNode*    node       = new ASTNode(ASTType::Typedef, &tokens[start - 1]);
-	StringNode* stringNode = new StringNode(name.string, &name);
+	ASTNode*    node       = new ASTNode(ASTType::Typedef, tokens[start - 1].loc);
+	StringNode* stringNode = new StringNode(NameTable::Add(name.string), name.loc);
 
 	node->AddNode(type);
 	node->AddNode(stringNode);
@@ -326,14 +543,14 @@ uint64 Syntax::ParseTypedef(Tokens& tokens, uint64 start, ASTNode* currentNode)
 	return index;
 }
 
-uint64 Syntax::ParseTypeDeclaration(Tokens& tokens, uint64 start, TypeNode* typeNode) {
+uint64 Syntax::ParseTypeDeclaration(const TokenCursor& tokens, uint64 start, TypeNode* typeNode) {
 	bool identifierAdded = false;
 
 	while (true) {
 		Token& token = tokens[start];
 
 		if ((token.type == TokenType::Identifier || token.type == TokenType::PrimitiveType) && !identifierAdded) {
-			typeNode->AddToken(&token);
+			typeNode->AddToken(token);
 
 			if (token.type == TokenType::Identifier) {
 				identifierAdded = true;
@@ -355,8 +572,8 @@ uint64 Syntax::ParseTypeDeclaration(Tokens& tokens, uint64 start, TypeNode* type
 	return start;
 }
 
-uint64 Syntax::ParseStruct(Tokens& tokens, uint64 start, ASTNode* currentNode) {
-	ASTNode* strct  = new ASTNode(ASTType::Struct, &tokens[start - 1]);
+uint64 Syntax::ParseStruct(const TokenCursor& tokens, uint64 start, ASTNode* currentNode) {
+	ASTNode* strct  = new ASTNode(ASTType::Struct, tokens[start - 1].loc);
 	Token&   stName = tokens[start++];
 
 	if (!CheckName(stName)) {
@@ -364,7 +581,7 @@ uint64 Syntax::ParseStruct(Tokens& tokens, uint64 start, ASTNode* currentNode) {
 		return ~0;
 	}
 
-	strct->AddNode(new StringNode(stName.string, &stName));
+	strct->AddNode(new StringNode(NameTable::Add(stName.string), stName.loc));
 
 	Token& bracket = tokens[start++];
 
@@ -374,7 +591,7 @@ uint64 Syntax::ParseStruct(Tokens& tokens, uint64 start, ASTNode* currentNode) {
 	}
 
 	while (true) {
-		TypeNode* type = new TypeNode(&tokens[start]);
+		TypeNode* type = new TypeNode(tokens[start].loc);
 
 		start = ParseTypeDeclaration(tokens, start, type);
 
@@ -382,7 +599,7 @@ uint64 Syntax::ParseStruct(Tokens& tokens, uint64 start, ASTNode* currentNode) {
 			return ~0;
 
 		Token&      name       = tokens[start++];
-		StringNode* stringNode = new StringNode(name.string, &name);
+		StringNode* stringNode = new StringNode(NameTable::Add(name.string), name.loc);
 
 		if (!CheckName(name)) {
 			Compiler::Log(stName, HC_ERROR_SYNTAX_ILLEGAL_VARIABLE_NAME);
@@ -418,21 +635,21 @@ uint64 Syntax::ParseStruct(Tokens& tokens, uint64 start, ASTNode* currentNode) {
 	return start;
 }
 
-uint64 Syntax::ParseFunctionParameters(Tokens& tokens, uint64 start, ASTNode* functionNode) {
+uint64 Syntax::ParseFunctionParameters(const TokenCursor& tokens, uint64 start, ASTNode* functionNode) {
 	for (uint64 i = start + 1; i < tokens.GetSize(); i++) {
 		Token& token = tokens[i];
 
 		if (token.type == TokenType::ParenthesisClose)
 			return i + 1;
 
-		TypeNode* paramType = new TypeNode(&token);
+		TypeNode* paramType = new TypeNode(token.loc);
 
 		i = ParseTypeDeclaration(tokens, i, paramType);
 
 		if (i == ~0)
 			return ~0;
 
-		ASTNode* param = new ASTNode(ASTType::Parameter, &token);
+		ASTNode* param = new ASTNode(ASTType::Parameter, token.loc);
 
 		param->AddNode(paramType);
 
@@ -452,8 +669,8 @@ uint64 Syntax::ParseFunctionParameters(Tokens& tokens, uint64 start, ASTNode* fu
 				return ~0;
 			}
 
-			param->AddNode(new StringNode(nameToken.string, &nameToken));
-			param->token = &nameToken;
+			param->AddNode(new StringNode(NameTable::Add(nameToken.string), nameToken.loc));
+			param->loc = nameToken.loc;
 		}
 
 		Token& commaToken = tokens[++i];
@@ -473,144 +690,166 @@ uint64 Syntax::ParseFunctionParameters(Tokens& tokens, uint64 start, ASTNode* fu
 	return ~0;
 }
 
-uint64 Syntax::ParseExpression(Tokens& tokens, uint64 start, ASTNode* currentNode) {
-	List<ASTNode*> nodes;
-	List<ASTNode*> addAfter;
+uint64 Syntax::ParseExpression(const TokenCursor& tokens, uint64 start, ASTNode* currentNode) {
+	// Function arguments and layout parameters are a comma separated list ended by ')'
+	bool parameters = currentNode->nodeType == ASTType::Function || currentNode->nodeType == ASTType::Layout;
 
-	static uint32 parenthesesCount = 0;
+	if (parameters && tokens[start].type == TokenType::ParenthesisClose)
+		return start;
 
-	for (uint64 i = start; i < tokens.GetSize(); i++) {
-		Token& token = tokens[i];
+	while (true) {
+		ASTNode* node = ParseBinary(tokens, &start, 0);
 
-		if (token.type == TokenType::ParenthesisOpen) {
-			parenthesesCount++;
-			ASTNode tmp(ASTType::Root);
+		if (node == nullptr)
+			return ~0;
 
-			i = ParseExpression(tokens, i + 1, &tmp);
+		currentNode->AddNode(node);
 
-			nodes.PushBack(tmp.branches[0]);
-		} else if (token.type == TokenType::ParenthesisClose) {
-			if (parenthesesCount == 0 && !(currentNode->nodeType == ASTType::Function || currentNode->nodeType == ASTType::Layout)) {
-				Compiler::Log(token, HC_ERROR_SYNTAX_ERROR);
-				return ~0;
-			}
+		Token& token = tokens[start];
 
-			parenthesesCount--;
+		if (token.type == TokenType::Comma) {
+			start++;
+		} else if (token.type == TokenType::Semicolon || (parameters && token.type == TokenType::ParenthesisClose)) {
+			return start;
+		} else {
+			Compiler::Log(token, HC_ERROR_SYNTAX_EXPECTED, parameters ? ")" : ";");
+			return ~0;
+		}
+	}
+}
 
-			start = i;
+ASTNode* Syntax::ParseOperand(const TokenCursor& tokens, uint64* index) {
+	Token& token = tokens[*index];
 
-			break;
-		} else if (token.type == TokenType::Literal || token.type == TokenType::Identifier || token.type == TokenType::PrimitiveType) {
-			if (nodes.GetSize() > 0) {
-				ASTNode* node = nodes.Back();
+	if (token.type == TokenType::ParenthesisOpen) {
+		(*index)++;
 
-				if (!(node->nodeType == ASTType::Operator && node->branches.GetSize() == 0)) {
-					Compiler::Log(token, HC_ERROR_SYNTAX_EXPECTED, ";");
-					return ~0;
-				}
-			}
+		ASTNode* node = ParseBinary(tokens, index, 0);
 
-			nodes.PushBack(CreateOperandNode(tokens, &i));
-		} else if (token.type == TokenType::Operator) {
-			nodes.PushBack(new OperatorNode(token.operatorType, &token));
-		} else if (token.type == TokenType::Semicolon) {
-			start = i;
-			break;
-		} else if (token.type == TokenType::Comma) {
-			ASTNode tmp(currentNode->nodeType);
+		if (node == nullptr)
+			return nullptr;
 
-			i = ParseExpression(tokens, i + 1, &tmp);
+		Token& close = tokens[*index];
 
-			if (i == ~0) {
-				//TODO: error
-				HC_ASSERT(false);
-			}
+		if (close.type != TokenType::ParenthesisClose) {
+			Compiler::Log(close, HC_ERROR_SYNTAX_EXPECTED, ")");
+			return nullptr;
+		}
 
-			for (ASTNode* node : tmp.branches) {
-				addAfter.PushBack(node);
-			}
+		(*index)++;
 
-			start = i;
-			break;
+		return node;
+	} else if (token.type == TokenType::Operator) {
+		// The lexer can't always tell a negation from a subtraction, the position decides
+		OperatorType type   = token.operatorType == OperatorType::OpSub ? OperatorType::OpNegate : token.operatorType;
+		uint32       prefix = operatorPrecedence[(uint64)type].prefix;
+
+		if (prefix == 0) {
+			Compiler::Log(token, HC_ERROR_SYNTAX_ERROR);
+			return nullptr;
 		}
+
+		(*index)++;
+
+		ASTNode* operand = ParseBinary(tokens, index, prefix);
+
+		if (operand == nullptr)
+			return nullptr;
+
+		if (type == OperatorType::OpInc) {
+			type = OperatorType::OpPreInc;
+		} else if (type == OperatorType::OpDec) {
+			type = OperatorType::OpPreDec;
+		}
+
+		OperatorNode* node = new OperatorNode(type, token.loc);
+
+		node->AddNode(operand);
+
+		return node;
 	}
 
-	for (uint64 i = 0; i < nodes.GetSize(); i++) {
-		ASTNode* node = nodes[i];
+	return CreateOperandNode(tokens, index);
+}
 
-		if (node->nodeType == ASTType::Operator && node->branches.GetSize() == 0) {
-			OperatorTypeDef op = GetOperator(nodes, i);
+ASTNode* Syntax::ParseBinary(const TokenCursor& tokens, uint64* index, uint32 minPrecedence) {
+	ASTNode* left = ParseOperand(tokens, index);
 
-			bool cont = false;
-			uint64 nextOpEnd = 2;
+	if (left == nullptr)
+		return nullptr;
 
-			for (uint64 j = 1; j <= nextOpEnd; j++) {
-				uint64 index = i + j;
+	while (true) {
+		Token& token = tokens[*index];
 
-				if (index >= nodes.GetSize()) break;
+		if (token.type != TokenType::Operator || token.operatorType == OperatorType::OpSqBracketClose)
+			break;
 
-				ASTNode* next = nodes[index];
+		OperatorType type = token.operatorType == OperatorType::OpNegate ? OperatorType::OpSub : token.operatorType;
 
-				if (next->nodeType == ASTType::Operator) {
-					if (next->branches.GetSize() > 0) {
-						nextOpEnd += 2;
-						continue;
-					}
+		const OperatorPrecedence& prec = operatorPrecedence[(uint64)type];
 
-					OperatorTypeDef nextOp = GetOperator(((OperatorNode*)next)->type, OperandType::Any, OperandType::Any, true);
+		if (prec.postfix != 0) {
+			if (prec.postfix < minPrecedence)
+				break;
 
-					if ((nextOp.precedence < op.precedence) || (nextOp.precedence == op.precedence && op.associativty == OperatorAssociativity::RTL)) {
-						// Next operator has priority
+			OperatorNode* node = new OperatorNode(type == OperatorType::OpInc ? OperatorType::OpPostInc : OperatorType::OpPostDec, token.loc);
 
-						i += j - 1;
+			node->AddNode(left);
 
-						cont = true;
+			left = node;
 
-						break;
-					}
-				}
-			}
+			(*index)++;
+		} else if (type == OperatorType::OpSqBracketOpen) {
+			if (prec.infix < minPrecedence)
+				break;
 
-			if (cont) continue;
+			(*index)++;
 
-			if (op.leftOperand != OperandType::None) {
-				ASTNode* operand = nodes[--i];
+			ASTNode* subscript = ParseBinary(tokens, index, 0);
 
-				if (operand->nodeType == ASTType::Operator && operand->branches.GetSize() == 0) {
-					//TODO: error
-					HC_ASSERT(false);
-				}
+			if (subscript == nullptr)
+				return nullptr;
 
-				node->AddNode(operand);
-				nodes.Remove(i);
+			Token& close = tokens[*index];
+
+			if (close.operatorType != OperatorType::OpSqBracketClose) {
+				Compiler::Log(close, HC_ERROR_SYNTAX_EXPECTED, "]");
+				return nullptr;
 			}
 
-			if (op.rightOperand != OperandType::None) {
-				ASTNode* operand = nodes[i + 1];
+			OperatorNode* node = new OperatorNode(type, token.loc);
 
-				if (operand->nodeType == ASTType::Operator && operand->branches.GetSize() == 0) {
-					//TODO: error
-					HC_ASSERT(false);
-				}
+			node->AddNode(left);
+			node->AddNode(subscript);
 
-				node->AddNode(operand);
-				nodes.Remove(i + 1);
-			}
+			left = node;
 
-			i = -1;
-		}
-	}
+			(*index)++;
+		} else {
+			if (prec.infix == 0 || prec.infix < minPrecedence)
+				break;
+
+			(*index)++;
 
-	currentNode->AddNode(nodes[0]);
+			// Left associative operators only take tighter operators as their right operand
+			ASTNode* right = ParseBinary(tokens, index, prec.associativity == OperatorAssociativity::LTR ? prec.infix + 1 : prec.infix);
 
-	for (ASTNode* node : addAfter) {
-		currentNode->AddNode(node);
+			if (right == nullptr)
+				return nullptr;
+
+			OperatorNode* node = new OperatorNode(type, token.loc);
+
+			node->AddNode(left);
+			node->AddNode(right);
+
+			left = node;
+		}
 	}
 
-	return start;
+	return left;
 }
 
-uint64 Syntax::ParseLayout(Tokens& tokens, uint64 start, ASTNode* currentNode) {
+uint64 Syntax::ParseLayout(const TokenCursor& tokens, uint64 start, ASTNode* currentNode) {
 	Token& parenthesisOpen = tokens[start];
 
 	if (parenthesisOpen.type != TokenType::ParenthesisOpen) {
@@ -618,7 +857,7 @@ uint64 Syntax::ParseLayout(Tokens& tokens, uint64 start, ASTNode* currentNode) {
 		return ~0;
 	}
 
-	LayoutNode* layout = new LayoutNode(&tokens[start - 1]);
+	LayoutNode* layout = new LayoutNode(tokens[start - 1].loc);
 
 	start = ParseExpression(tokens, start + 1, layout);
 
@@ -654,7 +893,7 @@ uint64 Syntax::ParseLayout(Tokens& tokens, uint64 start, ASTNode* currentNode) {
 	start += 1;
 
 	if (layout->type == LayoutType::In || layout->type == LayoutType::Out) {
-		TypeNode* typeNode = new TypeNode(&tokens[start]);
+		TypeNode* typeNode = new TypeNode(tokens[start].loc);
 
 		start = ParseTypeDeclaration(tokens, start, typeNode);
 
@@ -663,7 +902,7 @@ uint64 Syntax::ParseLayout(Tokens& tokens, uint64 start, ASTNode* currentNode) {
 
 		Token&      name       = tokens[start++];
 		Token&      semiColon  = tokens[start];
-		StringNode* stringNode = new StringNode(name.string, &name);
+		StringNode* stringNode = new StringNode(NameTable::Add(name.string), name.loc);
 
 		layout->AddNode(typeNode);
 		layout->AddNode(stringNode);
@@ -673,6 +912,23 @@ uint64 Syntax::ParseLayout(Tokens& tokens, uint64 start, ASTNode* currentNode) {
 			return ~0;
 		}
 
+	} else if (layout->type != LayoutType::UniformBuffer) { // Samplers only have a name
+		Token& name      = tokens[start];
+		Token& semiColon = tokens[start + 1];
+
+		if (!CheckName(name)) {
+			Compiler::Log(name, HC_ERROR_SYNTAX_ILLEGAL_VARIABLE_NAME);
+			return ~0;
+		}
+
+		if (semiColon.type != TokenType::Semicolon) {
+			Compiler::Log(semiColon, HC_ERROR_SYNTAX_EXPECTED, ";");
+			return ~0;
+		}
+
+		layout->AddNode(new StringNode(NameTable::Add(name.string), name.loc));
+
+		start++;
 	} else {
 		Token& bracketOpen = tokens[start + 1];
 
@@ -688,16 +944,17 @@ uint64 Syntax::ParseLayout(Tokens& tokens, uint64 start, ASTNode* currentNode) {
 			ASTNode*    strct     = tmp.branches.Back();
 			StringNode* strctName = (StringNode*)strct->branches[0];
 
-			strctName->string += "_uniform_qwerty";
+			strctName->name = NameTable::Add(strctName->GetString() + "_uniform_qwerty");
 
-			layout->AddNode(new StringNode(name.string, &name));
+			layout->AddNode(new StringNode(NameTable::Add(name.string), name.loc));
 			layout->AddNode(strct);
 
 		} else {
-			TypeNode*   type       = new TypeNode(&tokens[start++]);
+			Token&      typeToken  = tokens[start++];
+			TypeNode*   type       = new TypeNode(typeToken.loc);
 			Token&      name       = tokens[start++];
 			Token&      semiColon  = tokens[start];
-			StringNode* stringNode = new StringNode(name.string, &name);
+			StringNode* stringNode = new StringNode(NameTable::Add(name.string), name.loc);
 
 			if (!CheckName(name)) {
 				Compiler::Log(name, HC_ERROR_SYNTAX_ILLEGAL_VARIABLE_NAME);
@@ -709,7 +966,7 @@ uint64 Syntax::ParseLayout(Tokens& tokens, uint64 start, ASTNode* currentNode) {
 				return ~0;
 			}
 
-			type->AddToken((Token*)type->token);
+			type->AddToken(typeToken);
 
 			layout->AddNode(type);
 			layout->AddNode(stringNode);
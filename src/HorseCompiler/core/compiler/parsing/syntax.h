@@ -30,23 +30,50 @@ SOFTWARE
 
 class Syntax {
 public:
-	static uint64 Analyze(Tokens& lexerResult, uint64 start, ASTNode* currentNode, Language* lang);
+	// With lazyBodies function bodies are only skipped over and stored as a BodyNode, see ParseReachable.
+	// lexerResult is padded with EndOfFile tokens while it's parsed and left as it was, see TokenCursor
+	static uint64 Analyze(Tokens& lexerResult, uint64 start, ASTNode* currentNode, const Language* lang, bool lazyBodies = false);
+	// Parses the top level declarations on numThreads threads (0 uses every hardware thread), the resulting tree
+	// and diagnostics are the same as Analyze with start 0
+	static uint64 AnalyzeParallel(Tokens& lexerResult, ASTNode* root, const Language* lang, uint32 numThreads, bool lazyBodies = false);
+
+	// Parses the skipped body of a function definition
+	static uint64 ParseBody(Tokens& lexerResult, ASTNode* function, const Language* lang);
+	// Parses the skipped bodies of every function the entry point can reach through calls.
+	// numSkipped is set to the number of bodies that are left unparsed
+	static uint64 ParseReachable(Tokens& lexerResult, ASTNode* root, const String& entryPoint, const Language* lang, uint64* numSkipped);
+
+	// Index of the first token of every top level declaration, found by tracking brace depth
+	static List<uint64> FindTopLevelDeclarations(const Tokens& tokens);
 
 private:
-	Syntax(Language* lang) : lang(lang) { }
-
-	Language* lang;
-
-	uint64 Analyze(Tokens& lexerResult, uint64 start, ASTNode* currentNode);
-
-	bool            CheckName(const Token& token);
-	OperatorTypeDef GetOperator(OperatorType type, OperandType left, OperandType right, bool ignoreOperands);
-	OperatorTypeDef GetOperator(List<ASTNode*>& nodes, uint64 index);
-	ASTNode*        CreateOperandNode(Tokens& tokens, uint64* index);
-	uint64          ParseTypedef(Tokens& tokens, uint64 start, ASTNode* currentNode);
-	uint64          ParseTypeDeclaration(Tokens& tokens, uint64 start, TypeNode* typeNode);
-	uint64          ParseStruct(Tokens& tokens, uint64 start, ASTNode* currentNode);
-	uint64          ParseFunctionParameters(Tokens& tokens, uint64 start, ASTNode* functionNode);
-	uint64          ParseExpression(Tokens& tokens, uint64 start, ASTNode* currentNode);
-	uint64          ParseLayout(Tokens& tokens, uint64 start, ASTNode* currentNode);
+	Syntax(const Language* lang);
+
+	// Binding power of an operator, higher binds tighter. 0 if the operator can't be used that way
+	struct OperatorPrecedence {
+		uint32                prefix;
+		uint32                infix;
+		uint32                postfix;
+		OperatorAssociativity associativity; // Of the infix operator
+	};
+
+	const Language*    lang;
+	OperatorPrecedence operatorPrecedence[(uint64)OperatorType::OpCount];
+	uint64             currentScope;
+	uint64             end; // Analyze stops at this token
+	bool               lazyBodies;
+
+	uint64 Analyze(const TokenCursor& tokens, uint64 start, ASTNode* currentNode);
+
+	uint64   FindClosingBracket(const TokenCursor& tokens, uint64 open) const;
+	bool     CheckName(const Token& token);
+	ASTNode* CreateOperandNode(const TokenCursor& tokens, uint64* index);
+	ASTNode* ParseOperand(const TokenCursor& tokens, uint64* index);
+	ASTNode* ParseBinary(const TokenCursor& tokens, uint64* index, uint32 minPrecedence);
+	uint64   ParseTypedef(const TokenCursor& tokens, uint64 start, ASTNode* currentNode);
+	uint64   ParseTypeDeclaration(const TokenCursor& tokens, uint64 start, TypeNode* typeNode);
+	uint64   ParseStruct(const TokenCursor& tokens, uint64 start, ASTNode* currentNode);
+	uint64   ParseFunctionParameters(const TokenCursor& tokens, uint64 start, ASTNode* functionNode);
+	uint64   ParseExpression(const TokenCursor& tokens, uint64 start, ASTNode* currentNode);
+	uint64   ParseLayout(const TokenCursor& tokens, uint64 start, ASTNode* currentNode);
 };
\ No newline at end of file
@@ -0,0 +1,210 @@
+/*
+MIT License
+
+Copyright (c) 2021 Jesper
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE
+*/
+
+#include "pass.h"
+
+#include <core/log/log.h>
+#include <core/compiler/parsing/astvisitor.h>
+
+#include <chrono>
+
+// State of a pass during a call to Run
+#define HC_PASS_PENDING 0
+#define HC_PASS_ACTIVE  1
+#define HC_PASS_DONE    2
+
+static uint64 CountNodes(ASTNode* root) {
+	ASTVisitor counter;
+
+	return counter.Walk(root);
+}
+
+PassManager::PassManager() : numNodes(0) {}
+
+PassManager::~PassManager() {
+	for (Pass* pass : passes) {
+		delete pass;
+	}
+}
+
+void PassManager::AddPass(Pass* pass) {
+	HC_ASSERT(FindPass(pass->GetName()) == ~0);
+
+	passes.PushBack(pass);
+	valid.PushBack(false);
+	statistics.PushBack({ String(pass->GetName()), 0, 0, 0, 0, 0 });
+}
+
+Pass* PassManager::GetPass(const String& name) const {
+	uint64 index = FindPass(name);
+
+	return index == ~0 ? nullptr : passes[index];
+}
+
+bool PassManager::Run(ASTNode* root) {
+	List<uint8> state;
+
+	for (uint64 i = 0; i < passes.GetSize(); i++) {
+		state.PushBack(HC_PASS_PENDING);
+	}
+
+	for (uint64 i = 0; i < passes.GetSize(); i++) {
+		if (!Run(i, root, state))
+			return false;
+	}
+
+	return true;
+}
+
+bool PassManager::Run(const String& name, ASTNode* root) {
+	uint64 index = FindPass(name);
+
+	if (index == ~0) {
+		Log::Error("unknown pass \"%s\"", name.str);
+		return false;
+	}
+
+	List<uint8> state;
+
+	for (uint64 i = 0; i < passes.GetSize(); i++) {
+		state.PushBack(HC_PASS_PENDING);
+	}
+
+	return Run(index, root, state);
+}
+
+void PassManager::Invalidate() {
+	for (uint64 i = 0; i < valid.GetSize(); i++) {
+		valid[i] = false;
+	}
+
+	numNodes = 0;
+}
+
+void PassManager::RecordPhase(const String& name, double time, uint64 numNodes) {
+	phases.PushBack({ name, time, 0, numNodes, 1, 0 });
+}
+
+void PassManager::PrintStatistics() const {
+	double total = 0;
+
+	for (const Statistics& phase : phases) {
+		Log::Info("%-20s %10.3f ms", phase.name.str, phase.time);
+
+		total += phase.time;
+	}
+
+	for (const Statistics& stats : statistics) {
+		if (stats.numRuns == 0)
+			continue;
+
+		Log::Info("%-20s %10.3f ms, %u runs (%u cached), %llu nodes visited, %llu nodes after", stats.name.str, stats.time, stats.numRuns, stats.numCached, stats.numVisited, stats.numNodes);
+
+		total += stats.time;
+	}
+
+	Log::Info("%-20s %10.3f ms", "total", total);
+}
+
+uint64 PassManager::FindPass(const String& name) const {
+	for (uint64 i = 0; i < passes.GetSize(); i++) {
+		if (name == passes[i]->GetName())
+			return i;
+	}
+
+	return ~0;
+}
+
+bool PassManager::Run(uint64 index, ASTNode* root, List<uint8>& state) {
+	Pass*       pass  = passes[index];
+	Statistics& stats = statistics[index];
+
+	if (pass->IsAnalysis() && valid[index]) {
+		stats.numCached++;
+		return true;
+	}
+
+	// A transform that already ran as a dependency isn't run again
+	if (state[index] == HC_PASS_DONE && !pass->IsAnalysis())
+		return true;
+
+	if (state[index] == HC_PASS_ACTIVE) {
+		Log::Error("pass \"%s\" depends on itself", pass->GetName());
+		return false;
+	}
+
+	state[index] = HC_PASS_ACTIVE;
+
+	List<String> dependencies;
+
+	pass->GetDependencies(dependencies);
+
+	for (const String& dependency : dependencies) {
+		uint64 dep = FindPass(dependency);
+
+		if (dep == ~0) {
+			Log::Error("pass \"%s\" depends on \"%s\" which hasn't been added", pass->GetName(), dependency.str);
+			return false;
+		}
+
+		if (!Run(dep, root, state))
+			return false;
+	}
+
+	List<String> optional;
+
+	pass->GetOptionalDependencies(optional);
+
+	for (const String& dependency : optional) {
+		uint64 dep = FindPass(dependency);
+
+		if (dep != ~0 && !Run(dep, root, state))
+			return false;
+	}
+
+	uint64 numVisited = 0;
+
+	auto start = std::chrono::high_resolution_clock::now();
+	bool res   = pass->Run(*this, root, &numVisited);
+
+	stats.time += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	stats.numVisited += numVisited;
+	stats.numRuns++;
+
+	if (pass->IsAnalysis()) {
+		valid[index] = res;
+	} else {
+		// The tree may have changed, every analysis has to run again
+		Invalidate();
+	}
+
+	if (numNodes == 0)
+		numNodes = CountNodes(root);
+
+	stats.numNodes = numNodes;
+
+	state[index] = HC_PASS_DONE;
+
+	return res;
+}
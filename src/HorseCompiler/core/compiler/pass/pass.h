@@ -0,0 +1,105 @@
+/*
+MIT License
+
+Copyright (c) 2021 Jesper
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE
+*/
+
+#pragma once
+
+#include <core/def.h>
+#include <util/string.h>
+#include <util/list.h>
+#include <core/compiler/parsing/ast.h>
+
+class PassManager;
+
+class Pass {
+public:
+	virtual ~Pass() { }
+
+	virtual const char* GetName() const = 0;
+
+	// Names of the passes that must have run before this one
+	virtual void GetDependencies(List<String>& dependencies) const { }
+	// Names of the passes that must have run before this one if they've been added, for passes that are only added on request
+	virtual void GetOptionalDependencies(List<String>& dependencies) const { }
+
+	// An analysis only reads the tree, its result is reused until a pass that isn't an analysis runs
+	virtual bool IsAnalysis() const { return false; }
+
+	// Returns false on errors. numVisited is set to the number of nodes the pass looked at
+	virtual bool Run(PassManager& manager, ASTNode* root, uint64* numVisited) = 0;
+};
+
+/** PassManager
+* Owns and runs the passes over a tree. Dependencies are run first, optional ones only if they've been added, and
+* analyses are only rerun once the tree has been changed by another pass. Wall time, visited nodes and the size of the tree are recorded for every pass.
+*/
+
+class PassManager {
+public:
+	struct Statistics {
+		String name;
+		double time; // Milliseconds, summed over every run
+		uint64 numVisited;
+		uint64 numNodes; // Size of the tree after the last run
+		uint32 numRuns;
+		uint32 numCached; // Times an analysis was requested while its result was still valid
+	};
+
+private:
+	List<Pass*>      passes;
+	List<uint8>      valid; // Analysis result is up to date
+	List<Statistics> statistics;
+	List<Statistics> phases; // Work done before there's a tree, e.g lexing
+
+	uint64 numNodes;
+
+public:
+	PassManager();
+	~PassManager();
+
+	// The manager takes ownership of the pass, names must be unique
+	void  AddPass(Pass* pass);
+	Pass* GetPass(const String& name) const;
+
+	template <typename T>
+	T* GetPass(const String& name) const {
+		return (T*)GetPass(name);
+	}
+
+	// Runs every pass in the order they were added
+	bool Run(ASTNode* root);
+	// Runs a pass and everything it depends on
+	bool Run(const String& name, ASTNode* root);
+
+	// Marks every analysis as out of date, for changes made to the tree outside of the manager
+	void Invalidate();
+
+	void RecordPhase(const String& name, double time, uint64 numNodes);
+
+	const List<Statistics>& GetStatistics() const { return statistics; }
+	void                    PrintStatistics() const;
+
+private:
+	uint64 FindPass(const String& name) const;
+	bool   Run(uint64 index, ASTNode* root, List<uint8>& state);
+};
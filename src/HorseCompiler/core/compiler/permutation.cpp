@@ -0,0 +1,485 @@
+/*
+MIT License
+
+Copyright (c) 2021 Jesper
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE
+*/
+
+#include "permutation.h"
+
+#include <core/preprocessor/preprocessor.h>
+#include <util/file.h>
+#include <util/util.h>
+
+#include <chrono>
+#include <unordered_map>
+
+static double GetElapsed(std::chrono::high_resolution_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+struct FunctionRange {
+	String name;
+	uint64 start; // First token of the declaration
+	uint64 body;  // Opening brace
+	uint64 end;   // Closing brace
+};
+
+// Finds every function definition at global scope, "<type> name(...) { ... }"
+static void FindFunctions(const Tokens& tokens, List<FunctionRange>& functions) {
+	uint64 depth     = 0;
+	uint64 declStart = 0;
+
+	for (uint64 i = 0; i < tokens.GetSize(); i++) {
+		const Token& t = tokens[i];
+
+		if (t.isString || t.string.length != 1)
+			continue;
+
+		char c = t.string[0];
+
+		if (c == '{') {
+			if (depth++ > 0 || i == 0 || tokens[i - 1].string != ")")
+				continue;
+
+			uint64 parentheses = 0;
+			uint64 open        = i - 1;
+
+			for (; open > declStart; open--) {
+				const String& str = tokens[open].string;
+
+				if (str == ")") {
+					parentheses++;
+				} else if (str == "(" && --parentheses == 0) {
+					break;
+				}
+			}
+
+			if (open == declStart || parentheses != 0)
+				continue;
+
+			FunctionRange func;
+
+			func.name  = tokens[open - 1].string;
+			func.start = declStart;
+			func.body  = i;
+			func.end   = ~0;
+
+			functions.PushBack(func);
+		} else if (c == '}') {
+			if (depth == 0 || --depth > 0)
+				continue;
+
+			if (functions.GetSize() > 0 && functions[functions.GetSize() - 1].end == ~0 && functions[functions.GetSize() - 1].body < i)
+				functions[functions.GetSize() - 1].end = i;
+
+			declStart = i + 1;
+		} else if (c == ';' && depth == 0) {
+			declStart = i + 1;
+		}
+	}
+}
+
+// Marks the tokens that can end up in the final code: everything at global scope and functions reachable from the entry point
+static void FindReachable(const Tokens& tokens, const String& entryPoint, List<uint8>& keep) {
+	List<FunctionRange> functions;
+
+	FindFunctions(tokens, functions);
+
+	std::unordered_map<String, List<uint64>> byName; // Overloads share the name
+
+	for (uint64 i = 0; i < functions.GetSize(); i++) {
+		byName[functions[i].name].PushBack(i);
+	}
+
+	keep = List<uint8>();
+
+	for (uint64 i = 0; i < tokens.GetSize(); i++) {
+		keep.PushBack(true);
+	}
+
+	for (const FunctionRange& func : functions) {
+		uint64 end = func.end == ~0 ? tokens.GetSize() - 1 : func.end;
+
+		for (uint64 i = func.start; i <= end; i++) {
+			keep[i] = false;
+		}
+	}
+
+	auto entry = byName.find(entryPoint);
+
+	if (entry == byName.end()) {
+		Log::Warning("entry point \"%s\" not found, every function is considered reachable", entryPoint.str);
+
+		for (uint64 i = 0; i < keep.GetSize(); i++) {
+			keep[i] = true;
+		}
+
+		return;
+	}
+
+	List<uint64> work = entry->second;
+	List<uint8>  visited;
+
+	for (uint64 i = 0; i < functions.GetSize(); i++) {
+		visited.PushBack(false);
+	}
+
+	while (work.GetSize() > 0) {
+		uint64 index = work[work.GetSize() - 1];
+		work.PopBack();
+
+		if (visited[index])
+			continue;
+
+		visited[index] = true;
+
+		const FunctionRange& func = functions[index];
+		uint64               end  = func.end == ~0 ? tokens.GetSize() - 1 : func.end;
+
+		for (uint64 i = func.start; i <= end; i++) {
+			keep[i] = true;
+
+			if (i <= func.body)
+				continue;
+
+			auto called = byName.find(tokens[i].string);
+
+			if (called == byName.end())
+				continue;
+
+			for (uint64 f : called->second) {
+				if (!visited[f])
+					work.PushBack(f);
+			}
+		}
+	}
+}
+
+// The signature is only a hash, permutations are in the same class if their reachable tokens are equal
+static bool SameCode(const Tokens& a, const List<uint64>& reachableA, const Tokens& b, const List<uint64>& reachableB) {
+	if (reachableA.GetSize() != reachableB.GetSize())
+		return false;
+
+	for (uint64 i = 0; i < reachableA.GetSize(); i++) {
+		const Token& ta = a[reachableA[i]];
+		const Token& tb = b[reachableB[i]];
+
+		if (ta.type != tb.type || ta.string != tb.string)
+			return false;
+	}
+
+	return true;
+}
+
+static uint64 FindClass(const List<uint64>& classes, const List<Permutation>& permutations, const List<List<uint64>>& reachable, uint64 index) {
+	const Permutation& perm = permutations[index];
+
+	for (uint64 i = 0; i < classes.GetSize(); i++) {
+		const Permutation& other = permutations[classes[i]];
+
+		if (other.signature == perm.signature && SameCode(other.tokens, reachable[classes[i]], perm.tokens, reachable[index]))
+			return i;
+	}
+
+	return ~0;
+}
+
+PermutationCompiler::PermutationCompiler(const List<String>& includeDir, Compiler* compiler) : includeDir(includeDir), compiler(compiler), lexTime(0), totalTime(0) {}
+
+void PermutationCompiler::AddPermutation(const List<String>& defines) {
+	Permutation perm;
+
+	perm.defines = defines;
+	perm.ast              = nullptr;
+	perm.success          = false;
+	perm.time             = 0;
+	perm.signature        = 0;
+	perm.equivalenceClass = ~0;
+
+	permutations.PushBack(perm);
+}
+
+bool PermutationCompiler::LoadPermutations(const String& filename) {
+	if (!FileUtils::FileExist(filename)) {
+		Log::Error("failed to open permutation file \"%s\"", filename.str);
+		return false;
+	}
+
+	String file = FileUtils::LoadTextFile(filename);
+
+	List<String> defines;
+	uint64       start = ~0;
+
+	for (uint64 i = 0; i <= file.length; i++) {
+		char c = i < file.length ? file[i] : '\n';
+
+		if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+			if (start != ~0) {
+				defines.PushBack(file.SubString(start, i - 1));
+				start = ~0;
+			}
+
+			if (c == '\n') {
+				if (defines.GetSize() > 0 && defines[0][0] != '#')
+					AddPermutation(defines);
+
+				defines = List<String>();
+			}
+		} else if (start == ~0) {
+			start = i;
+		}
+	}
+
+	return true;
+}
+
+bool PermutationCompiler::Run(const String& filename, uint32 numThreads) {
+	auto start = std::chrono::high_resolution_clock::now();
+
+	const Tokens& source = tokenCache.Get(filename);
+
+	lexTime = GetElapsed(start);
+
+	ThreadUtils::ParallelFor(permutations.GetSize(), numThreads, [&](uint64 index) {
+		Permutation& perm  = permutations[index];
+		auto         begin = std::chrono::high_resolution_clock::now();
+
+		List<String> dirs = includeDir; // The preprocessor modifies the include directories
+		PreProcessor pp(dirs, compiler, &tokenCache);
+
+		perm.tokens  = source;
+		perm.success = true;
+
+		for (const String& define : perm.defines) {
+			if (!pp.AddDefine(define))
+				perm.success = false;
+		}
+
+		if (perm.success)
+			perm.success = pp.Run(perm.tokens);
+
+		perm.conditionals = pp.GetConditionals();
+
+		if (perm.success) {
+			perm.ast     = new ASTNode(ASTType::Root);
+			perm.success = Syntax::Analyze(perm.tokens, 0, perm.ast, Language::Default()) != ~0;
+		}
+
+		perm.time = GetElapsed(begin);
+	});
+
+	totalTime = GetElapsed(start);
+
+	for (const Permutation& perm : permutations) {
+		if (!perm.success)
+			return false;
+	}
+
+	return true;
+}
+
+void PermutationCompiler::PrintStatistics() {
+	double minTime = 0;
+	double maxTime = 0;
+	double sum     = 0;
+
+	for (uint64 i = 0; i < permutations.GetSize(); i++) {
+		const Permutation& perm = permutations[i];
+
+		String defines("");
+
+		for (const String& define : perm.defines) {
+			defines.Append(define).Append(" ");
+		}
+
+		Log::Info("Permutation %llu: %s-> %llu tokens in %.3f ms%s", i, defines.str, perm.tokens.GetSize(), perm.time, perm.success ? "" : " (failed)");
+
+		minTime = i == 0 || perm.time < minTime ? perm.time : minTime;
+		maxTime = perm.time > maxTime ? perm.time : maxTime;
+		sum += perm.time;
+	}
+
+	double avg = permutations.GetSize() > 0 ? sum / permutations.GetSize() : 0;
+
+	Log::Info("%llu permutations in %.3f ms, %llu files lexed once (main file %.3f ms)", permutations.GetSize(), totalTime, tokenCache.GetNumFiles(), lexTime);
+	Log::Info("Per permutation min %.3f ms, avg %.3f ms, max %.3f ms, total %.3f ms", minTime, avg, maxTime, sum);
+}
+
+uint64 PermutationCompiler::Prune(const String& entryPoint) {
+	classes = List<uint64>();
+
+	List<List<uint64>> reachable;
+
+	for (uint64 p = 0; p < permutations.GetSize(); p++) {
+		Permutation& perm   = permutations[p];
+		Tokens&      tokens = perm.tokens;
+
+		List<uint8> keep;
+
+		FindReachable(tokens, entryPoint, keep);
+
+		reachable.PushBack(List<uint64>());
+
+		uint64 hash = HashUtils::FNV1a(nullptr, 0);
+
+		for (uint64 i = 0; i < tokens.GetSize(); i++) {
+			if (!keep[i])
+				continue;
+
+			const Token& t = tokens[i];
+
+			hash = HashUtils::FNV1a(&t.type, sizeof(t.type), hash);
+			hash = HashUtils::FNV1a(t.string.str, t.string.length + 1, hash); // Include the null terminator to separate tokens
+
+			reachable[p].PushBack(i);
+
+			for (ConditionalBlock& block : perm.conditionals) {
+				if (block.file == t.loc.file && block.end != ~0 && t.loc.index >= block.start && t.loc.index <= block.end)
+					block.reached = true;
+			}
+		}
+
+		perm.signature = hash;
+
+		uint64 cls = FindClass(classes, permutations, reachable, p);
+
+		if (cls == ~0) {
+			cls = classes.GetSize();
+			classes.PushBack(p);
+		}
+
+		perm.equivalenceClass = cls;
+	}
+
+	// #if and #elif expressions aren't evaluated yet, a macro only tested by them can't tell permutations apart
+	std::unordered_map<String, bool> evaluated; // Macro to whether any #ifdef/#ifndef tests it
+
+	for (const Permutation& perm : permutations) {
+		for (const ConditionalBlock& block : perm.conditionals) {
+			for (const String& dep : block.dependencies) {
+				evaluated[dep] = evaluated[dep] || block.unevaluated.Find(dep) == ~0;
+			}
+		}
+	}
+
+	for (const Permutation& perm : permutations) {
+		for (const String& define : perm.defines) {
+			uint64 equal = define.Find('=', 0);
+			String name  = equal == String::npos || equal == 0 ? define : define.SubString(0, equal - 1);
+
+			auto it = evaluated.find(name);
+
+			if (it != evaluated.end() && !it->second) {
+				Log::Warning("macro \"%s\" is only tested by #if/#elif expressions, which aren't evaluated yet. Permutations that only differ in it are merged", name.str);
+				it->second = true; // Only report it once
+			}
+		}
+	}
+
+	return classes.GetSize();
+}
+
+void PermutationCompiler::PrintEquivalenceClasses() {
+	struct BlockUsage {
+		const ConditionalBlock* block;
+		uint64                  kept;    // Permutations where a branch was kept
+		uint64                  reached; // Permutations where the kept branch reached the final code
+	};
+
+	List<BlockUsage>                 blocks;
+	std::unordered_map<String, bool> tested; // Macros that any conditional depend on
+
+	for (const Permutation& perm : permutations) {
+		for (const ConditionalBlock& block : perm.conditionals) {
+			uint64 index = ~0;
+
+			for (uint64 i = 0; i < blocks.GetSize(); i++) {
+				if (blocks[i].block->file == block.file && blocks[i].block->line == block.line) {
+					index = i;
+					break;
+				}
+			}
+
+			if (index == ~0) {
+				index = blocks.GetSize();
+				blocks.PushBack({ &block, 0, 0 });
+			}
+
+			blocks[index].kept += block.branch != ~0;
+			blocks[index].reached += block.reached;
+
+			for (const String& dep : block.dependencies) {
+				tested[dep] = true;
+			}
+		}
+	}
+
+	for (const BlockUsage& usage : blocks) {
+		String deps("");
+
+		for (const String& dep : usage.block->dependencies) {
+			deps.Append(dep).Append(" ");
+		}
+
+		Log::Info("Conditional %s:%lld depends on %s- kept in %llu, reached in %llu of %llu permutations", usage.block->file->filename.str, usage.block->line, deps.str, usage.kept, usage.reached, permutations.GetSize());
+	}
+
+	for (const Permutation& perm : permutations) {
+		for (const String& define : perm.defines) {
+			uint64 equal = define.Find('=', 0);
+			String name  = equal == String::npos || equal == 0 ? define : define.SubString(0, equal - 1);
+
+			if (tested.find(name) == tested.end()) {
+				Log::Info("Macro \"%s\" isn't tested by any conditional", name.str);
+				tested[name] = true; // Only report it once
+			}
+		}
+	}
+
+	for (uint64 i = 0; i < permutations.GetSize(); i++) {
+		const Permutation& perm = permutations[i];
+
+		Log::Info("Permutation %llu -> class %llu (permutation %llu)", i, perm.equivalenceClass, classes[perm.equivalenceClass]);
+	}
+
+	Log::Info("%llu permutations reduced to %llu", permutations.GetSize(), classes.GetSize());
+}
+
+bool PermutationCompiler::WritePermutationMap(const String& filename) const {
+	String map("# permutation class defines\n");
+
+	for (uint64 i = 0; i < permutations.GetSize(); i++) {
+		const Permutation& perm = permutations[i];
+
+		char buf[64];
+		sprintf(buf, "%llu %llu", i, perm.equivalenceClass);
+
+		map.Append(buf);
+
+		for (const String& define : perm.defines) {
+			map.Append(" ").Append(define);
+		}
+
+		map.Append("\n");
+	}
+
+	return FileUtils::WriteFile(filename, map.str, map.length);
+}
@@ -0,0 +1,80 @@
+/*
+MIT License
+
+Copyright (c) 2021 Jesper
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE
+*/
+
+#pragma once
+
+#include <core/compiler/compiler.h>
+#include <core/preprocessor/tokencache.h>
+#include <core/preprocessor/preprocessor.h>
+#include <util/string.h>
+#include <util/list.h>
+
+struct Permutation {
+	List<String> defines; // "NAME" or "NAME=VALUE"
+	Tokens       tokens;  // Preprocessed source
+	ASTNode*     ast;     // Syntax tree of the preprocessed source
+	bool         success;
+	double       time; // Milliseconds spent in the preprocessor and parser
+
+	List<ConditionalBlock> conditionals;     // Conditionals processed for this permutation
+	uint64                 signature;        // Hash of the code reachable from the entry point, the tokens are compared if it matches
+	uint64                 equivalenceClass; // Permutations in the same class produce identical code
+};
+
+// Compiles one source under many define sets. The source and its includes are only
+// read and lexed once, every permutation runs the preprocessor and parser on its own thread
+class PermutationCompiler {
+private:
+	List<String>      includeDir;
+	Compiler*         compiler;
+	TokenCache        tokenCache;
+	List<Permutation> permutations;
+	List<uint64>      classes; // First permutation in every equivalence class
+
+	double lexTime;   // Milliseconds spent lexing the main file
+	double totalTime; // Milliseconds for the whole batch
+
+public:
+	PermutationCompiler(const List<String>& includeDir, Compiler* compiler);
+
+	void AddPermutation(const List<String>& defines);
+	// One permutation per line, defines are separated by spaces. Empty lines and lines starting with '#' are ignored
+	bool LoadPermutations(const String& filename);
+
+	// Preprocesses every permutation on numThreads threads, 0 uses every hardware thread. Returns false if any permutation failed
+	bool Run(const String& filename, uint32 numThreads);
+
+	void PrintStatistics();
+
+	// Groups the permutations into classes that produce identical code reachable from entryPoint,
+	// only global declarations and functions called from the entry point are compared. Returns the number of classes.
+	// Warns about macros only tested by #if/#elif, those expressions aren't evaluated yet so they never split a class
+	uint64 Prune(const String& entryPoint);
+	void   PrintEquivalenceClasses();
+	// Writes "<permutation> <class> <defines>" for every permutation, the engine only has to compile the first permutation in every class
+	bool WritePermutationMap(const String& filename) const;
+
+	List<Permutation>&  GetPermutations() { return permutations; }
+	const List<uint64>& GetEquivalenceClasses() const { return classes; }
+};
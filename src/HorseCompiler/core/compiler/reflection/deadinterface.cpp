@@ -0,0 +1,205 @@
+/*
+MIT License
+
+Copyright (c) 2021 Jesper
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE
+*/
+
+#include "deadinterface.h"
+
+#include <core/log/log.h>
+
+#include <unordered_map>
+#include <unordered_set>
+
+SymbolLayout* DeadInterfacePass::GetLayout(ASTNode* node) const {
+	if (node->nodeType != ASTType::Variable)
+		return nullptr;
+
+	Symbol* symbol = symbolTable->GetSymbol(((StringNode*)node->branches[0])->name);
+
+	if (symbol == nullptr || symbol->type != SymbolType::Variable || ((SymbolVariable*)symbol)->layout == LayoutType::Unknown)
+		return nullptr;
+
+	SymbolLayout* layout = (SymbolLayout*)symbol;
+
+	// The semantic pass typed the node with the variable the name resolved to in its scope, a different type means a
+	// local shadows the layout. Nodes outside expressions aren't typed
+	if (node->category != ValueCategory::Unknown && layout->type && node->typeId != layout->type->id)
+		return nullptr;
+
+	return layout;
+}
+
+bool DeadInterfacePass::Run(PassManager& manager, ASTNode* root, uint64* numVisited) {
+	std::unordered_map<NameId, List<ASTNode*>> functions; // Overloads share the name
+	List<ASTNode*>                             work;
+
+	*numVisited = 0;
+
+	for (ASTNode* node : root->branches) {
+		if (node->nodeType == ASTType::FunctionDefinition) {
+			functions[((StringNode*)node->branches[1])->name].PushBack(node);
+		} else if (node->nodeType == ASTType::VariableDefinition) {
+			// Global initializers run whatever the entry point is
+			work.PushBack(node);
+		}
+	}
+
+	auto entry = functions.find(NameTable::Add(entryPoint));
+
+	if (entry == functions.end()) {
+		Log::Warning("entry point \"%s\" not found, unused inputs, outputs and uniforms are kept", entryPoint.str);
+		return true;
+	}
+
+	struct Usage {
+		bool        whole = false; // Used as a whole, every member is needed
+		List<uint8> members;       // Members of a block that are accessed
+	};
+
+	std::unordered_map<SymbolLayout*, Usage> usage;
+	std::unordered_set<ASTNode*>             reached;
+
+	for (ASTNode* function : entry->second) {
+		reached.insert(function);
+		work.PushBack(function);
+	}
+
+	while (work.GetSize() > 0) {
+		ASTNode* node = work.Back();
+
+		work.PopBack();
+		(*numVisited)++;
+
+		if (node->nodeType == ASTType::Function) {
+			auto called = functions.find(((StringNode*)node->branches[0])->name);
+
+			if (called != functions.end()) {
+				for (ASTNode* callee : called->second) {
+					if (reached.insert(callee).second)
+						work.PushBack(callee);
+				}
+			}
+		} else if (node->nodeType == ASTType::Variable) {
+			SymbolLayout* layout = GetLayout(node);
+
+			if (layout)
+				usage[layout].whole = true;
+
+			continue;
+		} else if (node->nodeType == ASTType::Operator && ((OperatorNode*)node)->type == OperatorType::Dot) {
+			ASTNode*      right  = node->branches[1];
+			SymbolLayout* layout = GetLayout(node->branches[0]);
+
+			// The right operand names a member, it's never a variable
+			if (layout == nullptr) {
+				work.PushBack(node->branches[0]);
+				continue;
+			}
+
+			Usage& use   = usage[layout];
+			uint32 index = ~0u;
+
+			if (layout->type && layout->type->type == Type::Struct && right->nodeType == ASTType::Variable)
+				index = ((TypeStruct*)layout->type)->GetMember(((StringNode*)right->branches[0])->name);
+
+			if (index == ~0u) {
+				use.whole = true;
+				continue;
+			}
+
+			while (use.members.GetSize() <= index) {
+				use.members.PushBack(0);
+			}
+
+			use.members[index] = 1;
+			continue;
+		}
+
+		for (ASTNode* branch : node->branches) {
+			work.PushBack(branch);
+		}
+	}
+
+	std::unordered_set<ASTNode*> removed;
+
+	// A function that's never called can still name the layouts removed below, so it goes too
+	for (ASTNode* node : root->branches) {
+		if (node->nodeType != ASTType::FunctionDefinition || reached.find(node) != reached.end())
+			continue;
+
+		removed.insert(node);
+
+		Log::Info("removed function '%s', it isn't called by \"%s\"", ((StringNode*)node->branches[1])->GetString().str, entryPoint.str);
+	}
+
+	for (Symbol* symbol : symbolTable->symbols) {
+		if (symbol->type != SymbolType::Variable || ((SymbolVariable*)symbol)->layout == LayoutType::Unknown)
+			continue;
+
+		SymbolLayout* layout = (SymbolLayout*)symbol;
+		auto          use    = usage.find(layout);
+
+		if (use == usage.end()) {
+			layout->dropped = true;
+			removed.insert(layout->node);
+
+			Log::Info("removed '%s', it isn't used by \"%s\"", layout->GetName().str, entryPoint.str);
+			continue;
+		}
+
+		// Other blocks use a struct that can be shared with code outside the shader
+		if (!layout->inlineBlock || use->second.whole)
+			continue;
+
+		TypeStruct*        block   = (TypeStruct*)layout->type;
+		const List<uint8>& members = use->second.members;
+		List<uint32>       order;
+
+		for (uint32 i = 0; i < block->elements.GetSize(); i++) {
+			if (i < members.GetSize() && members[i]) {
+				order.PushBack(i);
+				continue;
+			}
+
+			layout->droppedMembers.PushBack({ block->memberNames[i], block->elements[i], block->GetDeclaredIndex(i) });
+
+			Log::Info("removed '%s.%s', it isn't used by \"%s\"", layout->GetName().str, NameTable::Get(block->memberNames[i]).str, entryPoint.str);
+		}
+
+		if (order.GetSize() < block->elements.GetSize())
+			block->Reorder(order, layout->node->branches.Back());
+	}
+
+	if (removed.size() == 0)
+		return true;
+
+	List<ASTNode*> branches;
+
+	for (ASTNode* node : root->branches) {
+		if (removed.find(node) == removed.end())
+			branches.PushBack(node);
+	}
+
+	root->branches = branches;
+
+	return true;
+}
@@ -0,0 +1,50 @@
+/*
+MIT License
+
+Copyright (c) 2021 Jesper
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE
+*/
+
+#pragma once
+
+#include <core/def.h>
+#include <util/string.h>
+#include <core/compiler/misc/symboltable.h>
+#include <core/compiler/pass/pass.h>
+
+// Removes the functions the entry point doesn't call, the inputs, outputs, uniform buffers and samplers that the entry
+// point and the functions it calls don't use, and the unused members of uniform blocks declared inline. Removed layouts
+// stay in the symbol table marked as dropped, so the reflection can list them. Variables are matched by name and the
+// type the semantic pass gave them, so only a local of the same type shadowing a layout keeps the layout
+class DeadInterfacePass : public Pass {
+private:
+	SymbolTable* symbolTable;
+	String       entryPoint;
+
+public:
+	DeadInterfacePass(SymbolTable* symbolTable, const String& entryPoint) : symbolTable(symbolTable), entryPoint(entryPoint) {}
+
+	const char* GetName() const override { return "dead-interface"; }
+	void        GetDependencies(List<String>& dependencies) const override { dependencies.PushBack("semantic"); }
+	bool        Run(PassManager& manager, ASTNode* root, uint64* numVisited) override;
+
+private:
+	SymbolLayout* GetLayout(ASTNode* node) const; // nullptr unless node is a Variable naming a layout
+};
@@ -0,0 +1,268 @@
+/*
+MIT License
+
+Copyright (c) 2021 Jesper
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE
+*/
+
+#include "reflection.h"
+
+#include <core/log/log.h>
+#include <util/file.h>
+
+#include <string.h>
+
+static uint64 Align(uint64 offset) {
+	return (offset + 7) & ~7ull;
+}
+
+// Component type and dimensions shared by members and resources
+static void SetType(const Type* type, uint8* baseType, uint8* bits, uint8* columns, uint8* rows) {
+	const TypeScalar* scalar = nullptr;
+
+	*baseType = (uint8)Reflection::BaseType::None;
+	*bits     = 0;
+	*columns  = 1;
+	*rows     = 1;
+
+	if (type == nullptr)
+		return;
+
+	switch (type->type) {
+		case Type::Scalar:
+			scalar = (const TypeScalar*)type;
+			break;
+		case Type::Vec:
+			scalar   = ((const TypeVec*)type)->component;
+			*columns = ((const TypeVec*)type)->components;
+			break;
+		case Type::Mat:
+			scalar   = ((const TypeMat*)type)->component;
+			*columns = ((const TypeMat*)type)->columns;
+			*rows    = ((const TypeMat*)type)->rows;
+			break;
+		case Type::Struct:
+			*baseType = (uint8)Reflection::BaseType::Struct;
+			return;
+	}
+
+	if (scalar) {
+		*baseType = (uint8)(scalar->scalarType == TypeScalar::Float ? Reflection::BaseType::Float : scalar->sign == 0 ? Reflection::BaseType::Uint : Reflection::BaseType::Int);
+		*bits     = scalar->bits;
+	}
+}
+
+Reflection::Reflection() : rules(LayoutRules::Std140) {}
+
+bool Reflection::Build(const SymbolTable* symbolTable, LayoutRules rules) {
+	this->rules = rules;
+
+	resources  = List<Resource>();
+	members    = List<Member>();
+	stringData = List<char>();
+
+	stringOffsets.clear();
+
+	for (const Symbol* symbol : symbolTable->symbols) {
+		if (symbol->type != SymbolType::Variable || ((const SymbolVariable*)symbol)->layout == LayoutType::Unknown)
+			continue;
+
+		const SymbolLayout* layout = (const SymbolLayout*)symbol;
+		Resource            resource;
+		uint8               bits = 0;
+
+		memset(&resource, 0, sizeof(Resource));
+
+		resource.name        = AddString(layout->GetName());
+		resource.typeName    = AddString(layout->type ? layout->type->name : String(""));
+		resource.binding     = layout->binding;
+		resource.set         = layout->set;
+		resource.location    = layout->location;
+		resource.component   = layout->component;
+		resource.firstMember = Invalid;
+		resource.flags       = layout->dropped ? FlagDropped : 0;
+		resource.kind        = (uint8)layout->layout;
+
+		SetType(layout->type, &resource.baseType, &bits, &resource.columns, &resource.rows);
+
+		if (layout->type) {
+			TypeLayout typeLayout;
+
+			if (!MemoryLayout::GetLayout(layout->type, rules, &typeLayout) || (layout->type->type == Type::Struct && !AddMembers((const TypeStruct*)layout->type, 0, &resource.firstMember, &layout->droppedMembers))) {
+				Log::Error("type '%s' of '%s' can't be stored in a buffer", layout->type->name.str, layout->GetName().str);
+				return false;
+			}
+
+			resource.size = typeLayout.size;
+
+			if (layout->type->type == Type::Struct)
+				resource.numMembers = (uint32)(((const TypeStruct*)layout->type)->elements.GetSize() + layout->droppedMembers.GetSize());
+		}
+
+		resources.PushBack(resource);
+	}
+
+	return true;
+}
+
+bool Reflection::AddMembers(const TypeStruct* type, uint32 base, uint32* firstMember, const List<SymbolLayout::DroppedMember>* dropped) {
+	List<uint32> offsets;
+
+	if (!MemoryLayout::GetMemberOffsets(type, rules, &offsets))
+		return false;
+
+	uint32 first = (uint32)members.GetSize();
+
+	for (uint64 i = 0; i < type->elements.GetSize(); i++) {
+		const Type* element = type->elements[i];
+		TypeLayout  layout;
+		Member      member;
+
+		MemoryLayout::GetLayout(element, rules, &layout);
+
+		memset(&member, 0, sizeof(Member));
+
+		member.name          = AddString(NameTable::Get(type->memberNames[i]));
+		member.typeName      = AddString(element->name);
+		member.offset        = base + offsets[i];
+		member.size          = layout.size;
+		member.alignment     = layout.alignment;
+		member.matrixStride  = layout.matrixStride;
+		member.arrayStride   = layout.arrayStride;
+		member.firstMember   = Invalid;
+		member.declaredIndex = type->GetDeclaredIndex((uint32)i);
+
+		SetType(element, &member.baseType, &member.bits, &member.columns, &member.rows);
+
+		members.PushBack(member);
+	}
+
+	if (dropped) {
+		for (const SymbolLayout::DroppedMember& droppedMember : *dropped) {
+			Member member;
+
+			memset(&member, 0, sizeof(Member));
+
+			member.name          = AddString(NameTable::Get(droppedMember.name));
+			member.typeName      = AddString(droppedMember.type->name);
+			member.offset        = Invalid;
+			member.firstMember   = Invalid;
+			member.declaredIndex = droppedMember.declaredIndex;
+			member.flags         = FlagDropped;
+
+			SetType(droppedMember.type, &member.baseType, &member.bits, &member.columns, &member.rows);
+
+			members.PushBack(member);
+		}
+	}
+
+	// Nested members go after the whole level so the members of every struct stay contiguous
+	for (uint64 i = 0; i < type->elements.GetSize(); i++) {
+		if (type->elements[i]->type != Type::Struct)
+			continue;
+
+		const TypeStruct* nested = (const TypeStruct*)type->elements[i];
+		uint32            index  = Invalid;
+
+		if (!AddMembers(nested, base + offsets[i], &index))
+			return false;
+
+		members[first + i].firstMember = index;
+		members[first + i].numMembers  = (uint32)nested->elements.GetSize();
+	}
+
+	*firstMember = first;
+
+	return true;
+}
+
+uint32 Reflection::AddString(const String& string) {
+	auto it = stringOffsets.find(string);
+
+	if (it != stringOffsets.end())
+		return it->second;
+
+	uint32 offset = (uint32)stringData.GetSize();
+
+	for (uint64 i = 0; i < string.length; i++) {
+		stringData.PushBack(string[i]);
+	}
+
+	stringData.PushBack(0);
+	stringOffsets.emplace(string, offset);
+
+	return offset;
+}
+
+bool Reflection::Write(const String& filename) const {
+	Header header;
+
+	memset(&header, 0, sizeof(Header));
+
+	header.magic           = Magic;
+	header.version         = Version;
+	header.rules           = (uint32)rules;
+	header.numResources    = (uint32)resources.GetSize();
+	header.numMembers      = (uint32)members.GetSize();
+	header.resourcesOffset = Align(sizeof(Header));
+	header.membersOffset   = Align(header.resourcesOffset + sizeof(Resource) * header.numResources);
+	header.stringsOffset   = Align(header.membersOffset + sizeof(Member) * header.numMembers);
+	header.stringsSize     = stringData.GetSize();
+
+	uint64 size = header.stringsOffset + header.stringsSize;
+	byte*  data = new byte[size];
+
+	memset(data, 0, size);
+	memcpy(data, &header, sizeof(Header));
+
+	auto Copy = [data](uint64 offset, const void* source, uint64 size) {
+		if (size > 0)
+			memcpy(data + offset, source, size);
+	};
+
+	Copy(header.resourcesOffset, resources.GetData(), sizeof(Resource) * header.numResources);
+	Copy(header.membersOffset, members.GetData(), sizeof(Member) * header.numMembers);
+	Copy(header.stringsOffset, stringData.GetData(), header.stringsSize);
+
+	bool res = FileUtils::WriteFile(filename, data, size);
+
+	delete[] data;
+
+	if (!res) {
+		Log::Error("failed to write reflection \"%s\"", filename.str);
+	}
+
+	return res;
+}
+
+void ReflectionPass::GetOptionalDependencies(List<String>& dependencies) const {
+	// The reflection lists what's left after removing the unused interface and the offsets after packing
+	dependencies.PushBack("dead-interface");
+	dependencies.PushBack("uniform-packing");
+}
+
+bool ReflectionPass::Run(PassManager& manager, ASTNode* root, uint64* numVisited) {
+	*numVisited = symbolTable->symbols.GetSize();
+
+	if (!reflection.Build(symbolTable, rules))
+		return false;
+
+	return filename.length == 0 || reflection.Write(filename);
+}
@@ -0,0 +1,158 @@
+/*
+MIT License
+
+Copyright (c) 2021 Jesper
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE
+*/
+
+#pragma once
+
+#include <core/def.h>
+#include <util/string.h>
+#include <util/list.h>
+#include <core/compiler/misc/memorylayout.h>
+#include <core/compiler/misc/symboltable.h>
+#include <core/compiler/pass/pass.h>
+
+#include <unordered_map>
+
+/** Reflection
+* Interface of a module: inputs, outputs, uniform buffers with the offset of every member, and samplers. The blob is written
+* next to the module and contains no pointers, the engine maps it and reads the records in place without parsing anything.
+*
+* File format, all offsets are from the start of the file and every section is 8 byte aligned:
+* Header
+* Resources: Resource[numResources], in declaration order
+* Members:   Member[numMembers], the members of a block or struct are contiguous and in memory order, dropped members last
+* Strings:   char[stringsSize], every string is null terminated
+*/
+
+class Reflection {
+public:
+	static constexpr uint32 Invalid = ~0u;
+	static constexpr uint32 Magic   = 0x46455248; // "HREF"
+	static constexpr uint32 Version = 3;
+
+	// Removed because the entry point doesn't use it, see DeadInterfacePass. A dropped member has no offset or size
+	static constexpr uint32 FlagDropped = 1;
+
+	enum class BaseType : uint8 {
+		None, // Samplers
+		Float,
+		Int,
+		Uint,
+		Struct
+	};
+
+	struct Member {
+		uint32 name;          // Offset into the string data
+		uint32 typeName;      // Offset into the string data
+		uint32 offset;        // From the start of the block
+		uint32 size;
+		uint32 alignment;
+		uint32 matrixStride;  // 0 if the member isn't a matrix
+		uint32 arrayStride;   // 0 if the member isn't an array
+		uint32 firstMember;   // Members of a struct member, index into the members
+		uint32 numMembers;
+		uint32 declaredIndex; // Position in the declaration, differs from the position here if the block was reordered
+		uint32 flags;         // FlagDropped if the entry point doesn't use it, the offset is Invalid then
+		uint8  baseType;      // BaseType, of the components for vectors and matrices
+		uint8  bits;          // Of a component, 0 for structs
+		uint8  columns;       // Components of a vector, columns of a matrix, 1 otherwise
+		uint8  rows;          // Rows of a matrix, 1 otherwise
+	};
+
+	struct Resource {
+		uint32 name;        // Offset into the string data
+		uint32 typeName;    // Offset into the string data, empty for samplers
+		uint32 binding;     // Invalid if not given
+		uint32 set;         // Invalid for inputs and outputs
+		uint32 location;    // Invalid if not given
+		uint32 component;   // Invalid if not given
+		uint32 size;        // Of the block or the input or output, 0 for samplers
+		uint32 firstMember; // Members of a block, index into the members
+		uint32 numMembers;
+		uint32 flags;       // FlagDropped if the entry point doesn't use it
+		uint8  kind;        // LayoutType
+		uint8  baseType;    // BaseType, of the components for vectors and matrices
+		uint8  columns;     // Components of a vector, columns of a matrix, 1 otherwise
+		uint8  rows;        // Rows of a matrix, 1 otherwise
+	};
+
+	struct Header {
+		uint32 magic;
+		uint32 version;
+		uint32 rules; // LayoutRules the blocks are laid out with
+		uint32 numResources;
+		uint32 numMembers;
+		uint32 reserved;
+
+		uint64 resourcesOffset;
+		uint64 membersOffset;
+		uint64 stringsOffset;
+		uint64 stringsSize;
+	};
+
+private:
+	LayoutRules    rules;
+	List<Resource> resources;
+	List<Member>   members;
+	List<char>     stringData;
+
+	std::unordered_map<String, uint32> stringOffsets;
+
+public:
+	Reflection();
+
+	// Collects the layouts declared in the global scope, blocks are laid out with rules. Returns false if a block has a
+	// member that can't be stored in a buffer
+	bool Build(const SymbolTable* symbolTable, LayoutRules rules);
+	bool Write(const String& filename) const;
+
+	const List<Resource>& GetResources() const { return resources; }
+	const List<Member>&   GetMembers() const { return members; }
+	const char*           GetString(uint32 offset) const { return stringData.GetData() + offset; }
+
+private:
+	uint32 AddString(const String& string);
+	// Appends the members of a struct contiguously followed by the dropped ones, then the members of its struct members.
+	// Offsets are relative to base
+	bool AddMembers(const TypeStruct* type, uint32 base, uint32* firstMember, const List<SymbolLayout::DroppedMember>* dropped = nullptr);
+};
+
+// Builds the reflection after semantic analysis and writes it if a filename is given
+class ReflectionPass : public Pass {
+private:
+	const SymbolTable* symbolTable;
+	LayoutRules        rules;
+	String             filename;
+	Reflection         reflection;
+
+public:
+	ReflectionPass(const SymbolTable* symbolTable, LayoutRules rules, const String& filename) : symbolTable(symbolTable), rules(rules), filename(filename) {}
+
+	const char* GetName() const override { return "reflection"; }
+	void        GetDependencies(List<String>& dependencies) const override { dependencies.PushBack("semantic"); }
+	void        GetOptionalDependencies(List<String>& dependencies) const override;
+	bool        IsAnalysis() const override { return true; }
+	bool        Run(PassManager& manager, ASTNode* root, uint64* numVisited) override;
+
+	const Reflection& GetReflection() const { return reflection; }
+};
@@ -0,0 +1,63 @@
+/*
+MIT License
+
+Copyright (c) 2021 Jesper
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE
+*/
+
+#include "uniformpacking.h"
+
+#include <core/log/log.h>
+
+bool UniformPackingPass::Run(PassManager& manager, ASTNode* root, uint64* numVisited) {
+	*numVisited = symbolTable->symbols.GetSize();
+
+	for (Symbol* symbol : symbolTable->symbols) {
+		if (symbol->type != SymbolType::Variable || ((SymbolVariable*)symbol)->layout != LayoutType::UniformBuffer || !((SymbolLayout*)symbol)->inlineBlock)
+			continue;
+
+		SymbolLayout* layout = (SymbolLayout*)symbol;
+
+		// Nothing is emitted for a block the entry point doesn't use
+		if (layout->dropped)
+			continue;
+
+		TypeStruct*   block  = (TypeStruct*)layout->type;
+		TypeLayout    declared;
+		List<uint32>  order;
+		uint32        size = 0;
+
+		if (!MemoryLayout::GetLayout(block, rules, &declared) || !MemoryLayout::GetPackedOrder(block, rules, &order, &size)) {
+			Log::Error("uniform block '%s' has a member that can't be stored in a buffer", layout->GetName().str);
+			return false;
+		}
+
+		// The greedy order can lose to the declared one, which is kept then
+		if (size < declared.size) {
+			block->Reorder(order, layout->node->branches.Back());
+		} else {
+			size = declared.size;
+		}
+
+		Log::Info("uniform block '%s': %u bytes (%s), %u saved by reordering", layout->GetName().str, size, MemoryLayout::GetRulesName(rules), declared.size - size);
+	}
+
+	return true;
+}
@@ -0,0 +1,47 @@
+/*
+MIT License
+
+Copyright (c) 2021 Jesper
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE
+*/
+
+#pragma once
+
+#include <core/def.h>
+#include <core/compiler/misc/memorylayout.h>
+#include <core/compiler/misc/symboltable.h>
+#include <core/compiler/pass/pass.h>
+
+// Reorders the members of uniform blocks declared inline to leave less padding and prints the bytes saved per block.
+// Blocks using a struct declared elsewhere keep their order, the struct can be shared with code outside the shader.
+// The struct type and its AST node are both reordered, the reflection records where each member was declared
+class UniformPackingPass : public Pass {
+private:
+	SymbolTable* symbolTable;
+	LayoutRules  rules;
+
+public:
+	UniformPackingPass(SymbolTable* symbolTable, LayoutRules rules) : symbolTable(symbolTable), rules(rules) {}
+
+	const char* GetName() const override { return "uniform-packing"; }
+	void        GetDependencies(List<String>& dependencies) const override { dependencies.PushBack("semantic"); }
+	void        GetOptionalDependencies(List<String>& dependencies) const override { dependencies.PushBack("dead-interface"); }
+	bool        Run(PassManager& manager, ASTNode* root, uint64* numVisited) override;
+};
@@ -27,25 +27,84 @@ SOFTWARE
 #include <core/compiler/lexer/token.h>
 #include <core/compiler/language.h>
 #include <core/compiler/parsing/ast.h>
+#include <core/compiler/parsing/astvisitor.h>
+#include <core/compiler/pass/pass.h>
 #include <core/compiler/misc/symboltable.h>
 #include <core/compiler/misc/type.h>
 
-class Semantic {
+#include <unordered_map>
+
+class Semantic : private ASTVisitor {
 public:
-    static uint64 Analyze(ASTNode* node, TypeTable* typeTable, SymbolTable* symbolTable);
+    // Global declarations are collected in order, then function bodies are analyzed on numThreads threads (0 uses
+    // every hardware thread) against the finished globals. Diagnostics are printed in source order
+    static uint64 Analyze(ASTNode* node, TypeTable* typeTable, SymbolTable* symbolTable, ConstantPool* constantPool, uint64* numVisited = nullptr, uint32 numThreads = 1);
 
 private:
     TypeTable* typeTable;
     SymbolTable* symbolTable;
+    ConstantPool* constantPool;
+
+    List<ASTNode*> functions;  // Function definitions, analyzed once every global is declared
+    uint64         result;     // ~0 if any global declaration failed
+    uint64         typeErrors; // Operators whose operands don't fit, counted by TypeExpression
+
+    // Constant each variable holds at the statement being analyzed in a function body. Variables without an entry
+    // hold their initial value unless they're assigned somewhere, see GetValue. Locals are only kept here so
+    // bodies never add to the shared constant pool. Bodies are straight-line code so far, a branch would copy
+    // this and meet the copies where they join
+    std::unordered_map<SymbolVariable*, ConstantValue> values;
+    bool                                               inFunction;
 
-    Semantic(TypeTable* typeTable, SymbolTable* symbolTable) : typeTable(typeTable), symbolTable(symbolTable) {}
+    Semantic(TypeTable* typeTable, SymbolTable* symbolTable, ConstantPool* constantPool) : typeTable(typeTable), symbolTable(symbolTable), constantPool(constantPool), result(0), typeErrors(0), inFunction(false) {}
 
-    uint64 Analyze(ASTNode* root);
+    bool Enter(ASTNode* node) override;
 
     uint64 VariableDefinition(ASTNode* node);
+    uint64 FunctionDeclaration(ASTNode* node); // Declarations and definitions, adds the overload to the function symbol
+    uint64 FunctionDefinition(ASTNode* node);
+    uint64 LayoutDefinition(LayoutNode* node); // Declares the variable and resolves the type of a layout
+    uint64 LayoutParameter(ASTNode* parameter, SymbolLayout* layout); // binding, set, location or component = <constant>
+    void   MarkModified(ASTNode* function); // Flags the globals a function assigns
 
+    const ConstantValue* GetValue(SymbolVariable* variable) const; // nullptr if not constant
+    // Converts value to the type of the variable and records it, value is nullptr when what's assigned isn't constant
+    uint64 SetValue(SymbolVariable* variable, const ConstantValue* value, const CompactLocation& loc);
+    SymbolVariable* GetVariable(ASTNode* node) const; // nullptr if node isn't a known variable
+
+    // Folds the constant subexpressions of node, result is node or the ConstantNode replacing it
     uint64 ConstantEvaluation(ASTNode* node, ASTNode** result);
+    uint64 FoldBranch(ASTNode* node, uint64 index); // Folds a branch and replaces it with the result
     uint64 ProcessOperator(OperatorNode* node, ASTNode** result);
-    ASTNode* ExecuteOperator(OperatorType op, ASTNode* left, ASTNode* right); //Handles 2 operand operators
-    ASTNode* ExecuteOperator(OperatorType op, ASTNode* operand); //Handles single operand operators
+    uint64 ProcessAssignment(OperatorNode* node);
+    uint64 ProcessSwizzle(OperatorNode* node, ASTNode** result);
+    uint64 ProcessCall(ASTNode* node, ASTNode** result); // Folds int(), float(), vecN() and mat4() calls
+
+    // Types an expression bottom up and stores the type and value category on every node, typed nodes aren't
+    // visited again. Returns nullptr if the type isn't known. Operands that don't fit are reported and counted in
+    // typeErrors, operands whose type isn't known aren't, they're unknown symbols or already reported
+    Type* TypeExpression(ASTNode* node);
+    Type* TypeOperator(OperatorNode* node, ValueCategory* category);
+    Type* TypeCall(ASTNode* node, ValueCategory* category);
+    Type* TypeConstant(const ConstantValue& value);
+    Type* TypeMember(Type* type, NameId name); // Struct member or vector swizzle
+    // Result types follow ConstantValue::Evaluate, bytes and shorts are promoted to int like C
+    Type* TypeBinary(OperatorType op, Type* left, Type* right);
+    Type* TypeUnary(OperatorType op, Type* operand);
+    Type* TypeArithmetic(Type* left, Type* right); // Usual arithmetic conversions of two scalars
+    Type* Promote(Type* scalar);
+};
+
+class SemanticPass : public Pass {
+private:
+    TypeTable* typeTable;
+    SymbolTable* symbolTable;
+    ConstantPool* constantPool;
+    uint32 numThreads;
+
+public:
+    SemanticPass(TypeTable* typeTable, SymbolTable* symbolTable, ConstantPool* constantPool, uint32 numThreads = 1) : typeTable(typeTable), symbolTable(symbolTable), constantPool(constantPool), numThreads(numThreads) {}
+
+    const char* GetName() const override { return "semantic"; }
+    bool Run(PassManager& manager, ASTNode* root, uint64* numVisited) override;
 };
\ No newline at end of file
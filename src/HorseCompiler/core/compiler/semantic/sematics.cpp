@@ -25,25 +25,92 @@ SOFTWARE
 #include "semantic.h"
 #include <core/compiler/compiler.h>
 #include <core/compiler/misc/type.h>
+#include <util/util.h>
 
-uint64 Semantic::Analyze(ASTNode* node, TypeTable* typeTable, SymbolTable* symbolTable) {
-	Semantic sem(typeTable, symbolTable);
+uint64 Semantic::Analyze(ASTNode* node, TypeTable* typeTable, SymbolTable* symbolTable, ConstantPool* constantPool, uint64* numVisited, uint32 numThreads) {
+	Semantic sem(typeTable, symbolTable, constantPool);
 
-	return sem.Analyze(node);
-}
+	uint64 visited = sem.Walk(node);
+	uint64 result  = sem.result;
 
-uint64 Semantic::Analyze(ASTNode* root) {
-	List<ASTNode*>& branches = root->branches;
+	// Bodies see every global, and a global assigned in any function isn't known on entry to another
+	for (ASTNode* function : sem.functions) {
+		sem.MarkModified(function);
+	}
 
-	for (uint64 i = 0; i < branches.GetSize(); i++) {
-		ASTNode* node = branches[i];
+	if (numThreads == 0)
+		numThreads = ThreadUtils::GetNumThreads();
 
-		if (node->nodeType == ASTType::VariableDefinition) {
-			uint64 res = VariableDefinition(node);
+	if (numThreads <= 1 || sem.functions.GetSize() <= 1) {
+		for (ASTNode* function : sem.functions) {
+			if (sem.FunctionDefinition(function) == ~0)
+				result = ~0;
+		}
+	} else {
+		struct Function {
+			uint64    result = 0;
+			LogBuffer log;
+		};
+
+		List<Function*> bodies;
+
+		for (uint64 i = 0; i < sem.functions.GetSize(); i++) {
+			bodies.PushBack(new Function());
+		}
+
+		// From here on the globals, types and constant pool are only read, every body gets its own scopes
+		ThreadUtils::ParallelFor(bodies.GetSize(), numThreads, [&](uint64 index) {
+			SymbolTable locals(symbolTable);
+			Semantic    body(typeTable, &locals, constantPool);
+
+			Log::BeginCapture(&bodies[index]->log);
+			bodies[index]->result = body.FunctionDefinition(sem.functions[index]);
+			Log::EndCapture();
+		});
+
+		for (Function* body : bodies) {
+			Log::Replay(body->log);
+
+			if (body->result == ~0)
+				result = ~0;
+
+			delete body;
 		}
 	}
 
-	return 0;
+	if (numVisited)
+		*numVisited = visited;
+
+	return result;
+}
+
+bool Semantic::Enter(ASTNode* node) {
+	uint64 res = 0;
+
+	if (node->nodeType == ASTType::VariableDefinition) {
+		res = VariableDefinition(node);
+	} else if (node->nodeType == ASTType::FunctionDeclaration) {
+		res = FunctionDeclaration(node);
+	} else if (node->nodeType == ASTType::FunctionDefinition) {
+		res = FunctionDeclaration(node);
+		functions.PushBack(node);
+	} else if (node->nodeType == ASTType::Layout) {
+		res = LayoutDefinition((LayoutNode*)node);
+	} else if (node->nodeType == ASTType::Struct) {
+		res = typeTable->CreateStruct(node) ? 0 : ~0;
+	} else if (node->nodeType == ASTType::Typedef) {
+		res = typeTable->CreateTypedef(node) ? 0 : ~0;
+	}
+
+	// The walk goes on so every global is reported, the error is returned once the bodies are analyzed
+	if (res == ~0)
+		result = ~0;
+
+	return node->nodeType == ASTType::Root;
+}
+
+bool SemanticPass::Run(PassManager& manager, ASTNode* root, uint64* numVisited) {
+	return Semantic::Analyze(root, typeTable, symbolTable, constantPool, numVisited, numThreads) != ~0;
 }
 
 uint64 Semantic::VariableDefinition(ASTNode* node) {
@@ -52,174 +119,990 @@ uint64 Semantic::VariableDefinition(ASTNode* node) {
 
 	bool        sameScope = false;
 	StringNode* name      = (StringNode*)node->branches[1];
-	Symbol*     symbol    = symbolTable->GetSymbol(name->string, &sameScope);
+	Symbol*     symbol    = symbolTable->GetSymbol(name->name, &sameScope);
 
 	if (symbol == nullptr || !sameScope) {
 		if (symbol) {
-			//Compiler::Log(*(name->token), HC_WARN_SEMANTIC_PARENT_SCOPE_SYMBOL_REDEFINITION);
+			//Compiler::Log(name->loc, name->name, HC_WARN_SEMANTIC_PARENT_SCOPE_SYMBOL_REDEFINITION);
 		}
 
-		symbol = new SymbolVariable(name->string, type, isConst, name->token);
+		symbol = new SymbolVariable(name->name, type, isConst, name->loc);
 	} else {
-		Compiler::Log(*(name->token), HC_ERROR_SEMANTIC_SYMBOL_REDEFINITION);
+		Compiler::Log(name->loc, name->name, HC_ERROR_SEMANTIC_SYMBOL_REDEFINITION);
 		return ~0;
 	}
 
 	symbolTable->AddSymbol(symbol);
 
+	const ConstantValue* value = nullptr;
+
 	if (node->branches.GetSize() == 3) {
-		ASTNode* result;
+		if (FoldBranch(node, 2) == ~0)
+			return ~0;
+
+		if (node->branches[2]->nodeType == ASTType::Constant)
+			value = &((ConstantNode*)node->branches[2])->value;
+	}
+
+	return SetValue((SymbolVariable*)symbol, value, node->loc);
+}
+
+uint64 Semantic::FunctionDeclaration(ASTNode* node) {
+	StringNode* name      = (StringNode*)node->branches[1];
+	bool        sameScope = false;
+	Symbol*     symbol    = symbolTable->GetSymbol(name->name, &sameScope);
+
+	if (symbol && sameScope && symbol->type != SymbolType::Function) {
+		Compiler::Log(name->loc, name->name, HC_ERROR_SEMANTIC_SYMBOL_REDEFINITION);
+		return ~0;
+	}
+
+	if (symbol == nullptr || !sameScope) {
+		symbol = new SymbolFunction(name->name, name->loc);
+		symbolTable->AddSymbol(symbol);
+	}
+
+	SymbolFunction* function      = (SymbolFunction*)symbol;
+	uint32          numParameters = 0;
+
+	for (uint64 i = 2; i < node->branches.GetSize(); i++) {
+		if (node->branches[i]->nodeType == ASTType::Parameter)
+			numParameters++;
+	}
+
+	// A definition after a declaration is the same overload, parameter types aren't compared yet
+	if (function->GetOverload(numParameters))
+		return 0;
+
+	TypeNode* returnNode = (TypeNode*)node->branches[0];
+	Type*     returnType = nullptr;
+
+	if (returnNode->tokens.GetSize() != 1 || returnNode->tokens[0].primitiveType != PrimitiveType::Void) {
+		returnType = typeTable->CreateType(returnNode, nullptr);
+
+		if (returnType == nullptr)
+			return ~0;
+	}
+
+	function->overloads.PushBack({ node, returnType, numParameters });
+
+	return 0;
+}
+
+uint64 Semantic::FunctionDefinition(ASTNode* node) {
+	StringNode* name = (StringNode*)node->branches[1];
+
+	// The global function symbol is shared by every body, this one only owns the locals
+	Symbol* function = new Symbol(SymbolType::Function, name->name, name->loc);
+
+	symbolTable->PushScope(function);
+
+	inFunction = true;
+	values.clear();
 
-		uint64 error = ConstantEvaluation(node->branches[2], &result);
+	uint64 result = 0;
 
-		if (result->nodeType != ASTType::Constant) {
-			// TODO: handle errors with new logging system
+	for (uint64 i = 2; i < node->branches.GetSize(); i++) {
+		ASTNode* statement = node->branches[i];
+		uint64   res       = 0;
+
+		switch (statement->nodeType) {
+			case ASTType::Parameter: {
+				if (statement->branches.GetSize() < 2)
+					break;
+
+				bool        isConst   = false;
+				Type*       type      = typeTable->CreateType(statement->branches[0], &isConst);
+				StringNode* paramName = (StringNode*)statement->branches[1];
+				bool        sameScope = false;
+
+				if (symbolTable->GetSymbol(paramName->name, &sameScope) && sameScope) {
+					Compiler::Log(paramName->loc, paramName->name, HC_ERROR_SEMANTIC_SYMBOL_REDEFINITION);
+					res = ~0;
+					break;
+				}
+
+				SymbolVariable* param = new SymbolVariable(paramName->name, type, isConst, paramName->loc);
+
+				// Arguments are only known at the call, so there's never a value
+				symbolTable->AddSymbol(param);
+				break;
+			}
+			case ASTType::VariableDefinition:
+				res = VariableDefinition(statement);
+				break;
+			case ASTType::Return:
+				if (statement->branches.GetSize() > 0)
+					res = FoldBranch(statement, 0);
+				break;
+			case ASTType::Operator:
+			case ASTType::Function:
+				res = FoldBranch(node, i);
+				break;
+			case ASTType::Struct:
+			case ASTType::Typedef: {
+				// The type table is shared by every body and only read while they're analyzed
+				StringNode* typeName = (StringNode*)statement->branches[statement->nodeType == ASTType::Struct ? 0 : 1];
+
+				Compiler::Log(typeName->loc, typeName->name, HC_ERROR_SEMANTIC_LOCAL_TYPE);
+				res = ~0;
+				break;
+			}
 		}
 
-		((SymbolVariable*)symbol)->initialValue = (ConstantNode*)result;
+		// Later statements are still analyzed to report as many errors as possible
+		if (res == ~0)
+			result = ~0;
+	}
+
+	symbolTable->PopScope();
+
+	inFunction = false;
+	values.clear();
+
+	return result;
+}
+
+uint64 Semantic::LayoutDefinition(LayoutNode* node) {
+	uint64 numParameters = 0;
+
+	// The parameters are expressions, the declaration starts at the first type or name
+	while (numParameters < node->branches.GetSize() && node->branches[numParameters]->nodeType != ASTType::Type && node->branches[numParameters]->nodeType != ASTType::String) {
+		numParameters++;
+	}
+
+	if (numParameters == node->branches.GetSize())
+		return ~0;
+
+	ASTNode*    declaration = node->branches[numParameters];
+	StringNode* name        = nullptr;
+	Type*       type        = nullptr;
+
+	if (declaration->nodeType == ASTType::Type) {
+		if (numParameters + 1 >= node->branches.GetSize())
+			return ~0;
+
+		name = (StringNode*)node->branches[numParameters + 1];
+		type = typeTable->CreateType(declaration, nullptr);
+	} else {
+		name = (StringNode*)declaration;
+
+		// A block declared inline, samplers have no type
+		if (numParameters + 1 < node->branches.GetSize())
+			type = typeTable->CreateStruct(node->branches[numParameters + 1]);
+	}
+
+	bool isSampler = node->type == LayoutType::Sampler1D || node->type == LayoutType::Sampler2D || node->type == LayoutType::Sampler3D;
+
+	if (type == nullptr && !isSampler)
+		return ~0;
+
+	bool    sameScope = false;
+	Symbol* symbol    = symbolTable->GetSymbol(name->name, &sameScope);
+
+	if (symbol && sameScope) {
+		Compiler::Log(name->loc, name->name, HC_ERROR_SEMANTIC_SYMBOL_REDEFINITION);
+		return ~0;
+	}
+
+	SymbolLayout* layout = new SymbolLayout(name->name, type, node, name->loc);
+	uint64        result = 0;
+
+	layout->inlineBlock = declaration->nodeType == ASTType::String && type != nullptr;
+
+	for (uint64 i = 0; i < numParameters; i++) {
+		if (LayoutParameter(node->branches[i], layout) == ~0)
+			result = ~0;
+	}
+
+	// Uniforms are in descriptor set 0 unless another set is given
+	if (layout->set == SymbolLayout::Invalid && node->type != LayoutType::In && node->type != LayoutType::Out)
+		layout->set = 0;
+
+	symbolTable->AddSymbol(layout);
+
+	return result;
+}
+
+uint64 Semantic::LayoutParameter(ASTNode* parameter, SymbolLayout* layout) {
+	// Anything but <name> = <value> is a builtin like Position
+	if (parameter->nodeType != ASTType::Operator || ((OperatorNode*)parameter)->type != OperatorType::OpAssign || parameter->branches[0]->nodeType != ASTType::Variable)
+		return 0;
+
+	StringNode*   name   = (StringNode*)parameter->branches[0]->branches[0];
+	const String& string = name->GetString();
+	uint32*       value  = nullptr;
+
+	if (string == "binding") {
+		value = &layout->binding;
+	} else if (string == "set") {
+		value = &layout->set;
+	} else if (string == "location") {
+		value = &layout->location;
+	} else if (string == "component") {
+		value = &layout->component;
+	} else {
+		return 0;
 	}
 
+	if (FoldBranch(parameter, 1) == ~0)
+		return ~0;
+
+	ASTNode* right = parameter->branches[1];
+
+	if (right->nodeType != ASTType::Constant || !((ConstantNode*)right)->value.IsInteger() || (((ConstantNode*)right)->value.type == ConstantType::Int && ((ConstantNode*)right)->value.i < 0)) {
+		Compiler::Log(name->loc, name->name, HC_ERROR_SEMANTIC_INVALID_LAYOUT_PARAMETER);
+		return ~0;
+	}
+
+	*value = ((ConstantNode*)right)->value.u;
+
 	return 0;
 }
 
+static bool IsAssignment(OperatorType op) {
+	switch (op) {
+		case OperatorType::OpAssign:
+		case OperatorType::OpCompoundAdd:
+		case OperatorType::OpCompoundSub:
+		case OperatorType::OpCompoundMul:
+		case OperatorType::OpCompoundDiv:
+		case OperatorType::OpPreInc:
+		case OperatorType::OpPreDec:
+		case OperatorType::OpPostInc:
+		case OperatorType::OpPostDec:
+			return true;
+	}
+
+	return false;
+}
+
+// The variable written by an assignment, skipping member and element accesses
+static ASTNode* GetAssignmentTarget(ASTNode* node) {
+	ASTNode* target = node->branches[0];
+
+	while (target->nodeType == ASTType::Operator && (((OperatorNode*)target)->type == OperatorType::Dot || ((OperatorNode*)target)->type == OperatorType::OpSqBracketOpen)) {
+		target = target->branches[0];
+	}
+
+	return target;
+}
+
+void Semantic::MarkModified(ASTNode* function) {
+	List<ASTNode*> stack;
+
+	stack.PushBack(function);
+
+	// Only globals are declared at this point, a local shadowing a global marks the global too which is
+	// merely conservative
+	while (stack.GetSize() > 0) {
+		ASTNode* node = stack.Back();
+
+		stack.PopBack();
+
+		for (ASTNode* branch : node->branches) {
+			stack.PushBack(branch);
+		}
+
+		if (node->nodeType != ASTType::Operator || !IsAssignment(((OperatorNode*)node)->type))
+			continue;
+
+		SymbolVariable* variable = GetVariable(GetAssignmentTarget(node));
+
+		if (variable)
+			variable->modified = true;
+	}
+}
+
+// The constant type holding values of type, false if constants of the type aren't tracked
+static bool GetConstantType(const Type* type, ConstantType* constantType) {
+	if (type == nullptr)
+		return false;
+
+	if (type->type == Type::Scalar) {
+		const TypeScalar* scalar = (const TypeScalar*)type;
+
+		// Bytes and shorts would have to be truncated
+		if (scalar->bits != 32)
+			return false;
+
+		*constantType = scalar->sign == 2 ? ConstantType::Float : scalar->sign == 0 ? ConstantType::Uint : ConstantType::Int;
+
+		return true;
+	} else if (type->type == Type::Vec) {
+		const TypeVec* vec = (const TypeVec*)type;
+
+		if (vec->component->sign != 2 || vec->component->bits != 32)
+			return false;
+
+		*constantType = vec->components == 2 ? ConstantType::Vec2 : vec->components == 3 ? ConstantType::Vec3 : ConstantType::Vec4;
+
+		return true;
+	} else if (type->type == Type::Mat) {
+		const TypeMat* mat = (const TypeMat*)type;
+
+		if (mat->component->sign != 2 || mat->component->bits != 32 || mat->columns != 4 || mat->rows != 4)
+			return false;
+
+		*constantType = ConstantType::Mat4;
+
+		return true;
+	}
+
+	return false;
+}
+
+uint64 Semantic::SetValue(SymbolVariable* variable, const ConstantValue* value, const CompactLocation& loc) {
+	ConstantType  type;
+	ConstantValue converted;
+
+	if (value && GetConstantType(variable->type, &type)) {
+		uint64 error = value->Convert(type, &converted);
+
+		if (error) {
+			Compiler::Log(loc, NameTable::Invalid, error, value->GetTypeName(), variable->type->name.str);
+			return ~0;
+		}
+	} else {
+		value = nullptr;
+	}
+
+	// In a body a missing entry is the same as not constant, locals never have an initial value and every
+	// global assigned in a body is marked modified before the bodies are analyzed
+	if (!inFunction) {
+		variable->initialValue = value ? constantPool->Add(converted) : ConstantPool::Invalid;
+	} else if (value) {
+		values[variable] = converted;
+	} else {
+		values.erase(variable);
+	}
+
+	return 0;
+}
+
+const ConstantValue* Semantic::GetValue(SymbolVariable* variable) const {
+	auto it = values.find(variable);
+
+	if (it != values.end())
+		return &it->second;
+
+	// Functions run in any order, so a global assigned in any of them isn't known on entry
+	if (inFunction && variable->modified && !variable->constness)
+		return nullptr;
+
+	return variable->initialValue == ConstantPool::Invalid ? nullptr : &constantPool->Get(variable->initialValue);
+}
+
+SymbolVariable* Semantic::GetVariable(ASTNode* node) const {
+	if (node->nodeType != ASTType::Variable)
+		return nullptr;
+
+	Symbol* symbol = symbolTable->GetSymbol(((StringNode*)node->branches[0])->name);
+
+	return symbol && symbol->type == SymbolType::Variable ? (SymbolVariable*)symbol : nullptr;
+}
+
+uint64 Semantic::FoldBranch(ASTNode* node, uint64 index) {
+	ASTNode* result = nullptr;
+
+	if (ConstantEvaluation(node->branches[index], &result) == ~0)
+		return ~0;
+
+	if (result != node->branches[index]) {
+		result->parent        = node;
+		node->branches[index] = result;
+	}
+
+	uint64 errors = typeErrors;
+
+	// Every expression is folded through here, so it's typed once it won't change anymore
+	TypeExpression(result);
+
+	return typeErrors == errors ? 0 : ~0;
+}
+
 uint64 Semantic::ConstantEvaluation(ASTNode* node, ASTNode** result) {
+	*result = node;
 
-	if (node->nodeType == ASTType::Constant) {
-		*result = node;
-	} else if (node->nodeType == ASTType::Variable) {
-		Symbol* symbol = symbolTable->GetSymbol(((StringNode*)node->branches[0])->string);
+	if (node->nodeType == ASTType::Variable) {
+		// Unknown symbols are left for the type checker to report
+		SymbolVariable*      variable = GetVariable(node);
+		const ConstantValue* value    = variable ? GetValue(variable) : nullptr;
 
-		if (symbol->type == SymbolType::Variable) {
-			SymbolVariable* smbl = (SymbolVariable*)symbol;
+		if (value)
+			*result = new ConstantNode(*value, node->loc);
+	} else if (node->nodeType == ASTType::Operator) {
+		return ProcessOperator((OperatorNode*)node, result);
+	} else if (node->nodeType == ASTType::Function) {
+		return ProcessCall(node, result);
+	}
+
+	return 0;
+}
 
-			if (smbl->initialValue != nullptr && !smbl->modified) {
-				*result = smbl->initialValue;
-			} else {
-				*result = node;
+uint64 Semantic::ProcessOperator(OperatorNode* node, ASTNode** result) {
+	switch (node->type) {
+		case OperatorType::OpAssign:
+		case OperatorType::OpCompoundAdd:
+		case OperatorType::OpCompoundSub:
+		case OperatorType::OpCompoundMul:
+		case OperatorType::OpCompoundDiv:
+		case OperatorType::OpPreInc:
+		case OperatorType::OpPreDec:
+		case OperatorType::OpPostInc:
+		case OperatorType::OpPostDec:
+			return ProcessAssignment(node);
+		case OperatorType::Dot:
+			return ProcessSwizzle(node, result);
+		case OperatorType::OpAnd:
+		case OperatorType::OpOr: {
+			if (FoldBranch(node, 0) == ~0)
+				return ~0;
+
+			ASTNode* left = node->branches[0];
+
+			// Like C the right operand isn't evaluated when the left decides the result, so 0 && 1 / 0 is fine
+			if (left->nodeType == ASTType::Constant && ((ConstantNode*)left)->value.IsScalar()) {
+				bool isTrue = ((ConstantNode*)left)->value.IsTrue();
+
+				if (isTrue == (node->type == OperatorType::OpOr)) {
+					*result = new ConstantNode(ConstantValue::Int(isTrue), node->loc);
+					return 0;
+				}
 			}
-		} else {
-			//TODO: error
-			HC_ASSERT(false);
+			break;
 		}
-	} else if (node->nodeType == ASTType::Operator) {
-		OperatorNode* op = (OperatorNode*)node;
+	}
+
+	bool constant = true;
+
+	for (uint64 i = 0; i < node->branches.GetSize(); i++) {
+		if (FoldBranch(node, i) == ~0)
+			return ~0;
+
+		constant &= node->branches[i]->nodeType == ASTType::Constant;
+	}
+
+	if (!constant)
+		return 0;
+
+	const ConstantValue& left = ((ConstantNode*)node->branches[0])->value;
 
-		uint64 res = ProcessOperator(op, result);
+	ConstantValue value;
+	uint64        error = 0;
 
+	if (node->branches.GetSize() == 1) {
+		error = ConstantValue::Evaluate(node->type, left, &value);
 	} else {
-		//TODO: error
-		HC_ASSERT(false);
+		error = ConstantValue::Evaluate(node->type, left, ((ConstantNode*)node->branches[1])->value, &value);
+	}
+
+	if (error) {
+		Compiler::Log(node->loc, NameTable::Invalid, error, left.GetTypeName(), node->branches.GetSize() == 1 ? "" : ((ConstantNode*)node->branches[1])->value.GetTypeName());
+		return ~0;
 	}
 
-	return uint64();
+	*result = new ConstantNode(value, node->loc);
+
+	return 0;
 }
 
-uint64 Semantic::ProcessOperator(OperatorNode* node, ASTNode** result) {
-	ASTNode* left = node->branches[0];
-	ASTNode* right = node->branches.GetSize() > 1 ? node->branches[1] : nullptr;
+uint64 Semantic::ProcessAssignment(OperatorNode* node) {
+	if (node->branches.GetSize() > 1 && FoldBranch(node, 1) == ~0)
+		return ~0;
+
+	// The target has to stay a variable, only subscripts in it are folded. Writing a member or an element
+	// changes part of the variable
+	ASTNode* target  = node->branches[0];
+	bool     partial = false;
+
+	while (target->nodeType == ASTType::Operator && (((OperatorNode*)target)->type == OperatorType::Dot || ((OperatorNode*)target)->type == OperatorType::OpSqBracketOpen)) {
+		if (((OperatorNode*)target)->type == OperatorType::OpSqBracketOpen && FoldBranch(target, 1) == ~0)
+			return ~0;
+
+		target  = target->branches[0];
+		partial = true;
+	}
+
+	SymbolVariable* variable = GetVariable(target);
+
+	// Anything else isn't assignable, that's for the type checker to report
+	if (variable == nullptr)
+		return 0;
+
+	if (variable->constness) {
+		StringNode* name = (StringNode*)target->branches[0];
+
+		Compiler::Log(name->loc, name->name, HC_ERROR_SEMANTIC_CONST_ASSIGNMENT);
+		return ~0;
+	}
+
+	// Globals assigned in a body were marked before the bodies run in parallel, only locals are still written here
+	if (!variable->modified)
+		variable->modified = true;
+
+	ASTNode*             right    = node->branches.GetSize() > 1 ? node->branches[1] : nullptr;
+	const ConstantValue* value    = right && right->nodeType == ASTType::Constant ? &((ConstantNode*)right)->value : nullptr;
+	const ConstantValue* current  = GetValue(variable);
+	OperatorType         op       = OperatorType::Unknown;
+	const ConstantValue* assigned = nullptr;
+	ConstantValue        result;
 
 	switch (node->type) {
 		case OperatorType::OpAssign:
-		case OperatorType::OpAdd:
-		case OperatorType::OpSub:
-		case OperatorType::OpMul:
-		case OperatorType::OpDiv:
+			assigned = value;
+			break;
 		case OperatorType::OpCompoundAdd:
+			op = OperatorType::OpAdd;
+			break;
 		case OperatorType::OpCompoundSub:
+			op = OperatorType::OpSub;
+			break;
 		case OperatorType::OpCompoundMul:
+			op = OperatorType::OpMul;
+			break;
 		case OperatorType::OpCompoundDiv:
-		case OperatorType::OpBitAnd:
-		case OperatorType::OpBitOr:
-		case OperatorType::OpBitXor:
-		case OperatorType::OpLeftShift:
-		case OperatorType::OpRightShift:
-		case OperatorType::OpAnd:
-		case OperatorType::OpOr:
-		case OperatorType::OpEqual:
-		case OperatorType::OpNotEqual:
-		case OperatorType::OpLess:
-		case OperatorType::OpGreater:
-		case OperatorType::OpLessEq:
-		case OperatorType::OpGreaterEq:
-			*result = ExecuteOperator(node->type, left, right);
+			op = OperatorType::OpDiv;
 			break;
-		case OperatorType::OpNegate:
-		case OperatorType::OpBitNot:
-		case OperatorType::OpNot:
-		case OperatorType::OpPostInc:
 		case OperatorType::OpPreInc:
-		case OperatorType::OpPostDec:
+		case OperatorType::OpPostInc:
+			op    = OperatorType::OpAdd;
+			value = &(result = ConstantValue::Int(1));
+			break;
 		case OperatorType::OpPreDec:
-			*result = ExecuteOperator(node->type, left);
+		case OperatorType::OpPostDec:
+			op    = OperatorType::OpSub;
+			value = &(result = ConstantValue::Int(1));
+			break;
+	}
+
+	if (op != OperatorType::Unknown && value && current) {
+		ConstantValue operand = *value;
+		uint64        error   = ConstantValue::Evaluate(op, *current, operand, &result);
+
+		if (error) {
+			Compiler::Log(node->loc, NameTable::Invalid, error, current->GetTypeName(), operand.GetTypeName());
+			return ~0;
+		}
+
+		assigned = &result;
+	}
+
+	return SetValue(variable, partial ? nullptr : assigned, node->loc);
+}
+
+uint64 Semantic::ProcessSwizzle(OperatorNode* node, ASTNode** result) {
+	if (FoldBranch(node, 0) == ~0)
+		return ~0;
+
+	ASTNode* left  = node->branches[0];
+	ASTNode* right = node->branches[1];
+
+	// Struct members aren't constants
+	if (left->nodeType != ASTType::Constant || right->nodeType != ASTType::Variable)
+		return 0;
+
+	const ConstantValue& vector     = ((ConstantNode*)left)->value;
+	StringNode*          components = (StringNode*)right->branches[0];
+
+	ConstantValue value;
+
+	uint64 error = vector.Swizzle(components->GetString(), &value);
+
+	if (error) {
+		Compiler::Log(components->loc, components->name, error, vector.GetTypeName());
+		return ~0;
+	}
+
+	*result = new ConstantNode(value, node->loc);
+
+	return 0;
+}
+
+// Type a call constructs, PrimitiveType::Unknown if it calls a function
+static PrimitiveType GetConstructor(NameId name) {
+	const String& string = NameTable::Get(name);
+
+	for (const PrimitiveTypeDef& def : Language::Default()->primitiveTypes) {
+		if (def.def == string)
+			return def.type;
+	}
+
+	return PrimitiveType::Unknown;
+}
+
+uint64 Semantic::ProcessCall(ASTNode* node, ASTNode** result) {
+	bool constant = true;
+
+	for (uint64 i = 1; i < node->branches.GetSize(); i++) {
+		if (FoldBranch(node, i) == ~0)
+			return ~0;
+
+		constant &= node->branches[i]->nodeType == ASTType::Constant;
+	}
+
+	StringNode*   name = (StringNode*)node->branches[0];
+	PrimitiveType type = GetConstructor(name->name);
+
+	switch (type) {
+		case PrimitiveType::Int:
+		case PrimitiveType::Float:
+		case PrimitiveType::Vec2:
+		case PrimitiveType::Vec3:
+		case PrimitiveType::Vec4:
+		case PrimitiveType::Mat4:
 			break;
 		default:
-			HC_ASSERT(false);
+			// The callee can assign any global, they're back to what GetValue assumes on entry
+			for (auto it = values.begin(); it != values.end();) {
+				if (it->first->parent == nullptr) {
+					it = values.erase(it);
+				} else {
+					it++;
+				}
+			}
+
+			return 0;
+	}
+
+	if (!constant)
+		return 0;
+
+	List<ConstantValue> args;
 
+	for (uint64 i = 1; i < node->branches.GetSize(); i++) {
+		args.PushBack(((ConstantNode*)node->branches[i])->value);
 	}
 
+	ConstantValue value;
+
+	uint64 error = ConstantValue::Construct(type, args.GetData(), args.GetSize(), &value);
+
+	if (error) {
+		Compiler::Log(name->loc, name->name, error);
+		return ~0;
+	}
+
+	*result = new ConstantNode(value, node->loc);
+
 	return 0;
 }
+// Only constants give a constant and only constants and uniforms a uniform. What a variable holds can differ
+// between invocations
+static ValueCategory Combine(ValueCategory a, ValueCategory b) {
+	if (a == ValueCategory::Constant && b == ValueCategory::Constant)
+		return ValueCategory::Constant;
 
-ASTNode* Semantic::ExecuteOperator(OperatorType op, ASTNode* left, ASTNode* right) {
-	if (op == OperatorType::OpAssign || op == OperatorType::OpCompoundAdd || op == OperatorType::OpCompoundSub || op == OperatorType::OpCompoundMul || op == OperatorType::OpCompoundDiv) {
-		if (left->nodeType != ASTType::Variable) {
-			//TODO: error
-			HC_ASSERT(false);
-		}
+	if ((a == ValueCategory::Constant || a == ValueCategory::Uniform) && (b == ValueCategory::Constant || b == ValueCategory::Uniform))
+		return ValueCategory::Uniform;
 
-		StringNode* lName = (StringNode*)left->branches[0];
-		Symbol* symbol = symbolTable->GetSymbol(lName->string);
+	return ValueCategory::Varying;
+}
 
-		if (symbol == nullptr) {
-			//TODO: error
-			HC_ASSERT(false);
-		}
+static bool IsInteger(const Type* type) {
+	return type && type->type == Type::Scalar && ((const TypeScalar*)type)->scalarType == TypeScalar::Int;
+}
 
-		if (symbol->type != SymbolType::Variable) {
-			//TODO: error
-			HC_ASSERT(false);
-		}
+Type* Semantic::TypeExpression(ASTNode* node) {
+	if (node->category != ValueCategory::Unknown)
+		return node->typeId == ~0u ? nullptr : typeTable->types[node->typeId];
 
-		SymbolVariable* smbl = (SymbolVariable*)symbol;
+	Type*         type     = nullptr;
+	ValueCategory category = ValueCategory::Varying;
 
-		if (smbl->constness) {
-			//TODO: error
-			HC_ASSERT(false);
-		}
+	switch (node->nodeType) {
+		case ASTType::Constant:
+			type     = TypeConstant(((ConstantNode*)node)->value);
+			category = ValueCategory::Constant;
+			break;
+		case ASTType::Variable: {
+			SymbolVariable* variable = GetVariable(node);
+
+			if (variable == nullptr)
+				break;
 
-		ConstantNode* rConstant = nullptr;
+			type = variable->type;
 
-		if (right->nodeType == ASTType::Operator) {
-			uint64 res = ProcessOperator((OperatorNode*)right, &right);
+			// A const global that wasn't folded is set once for every invocation, const locals and parameters
+			// are set per call
+			if (variable->layout == LayoutType::In) {
+				category = ValueCategory::Varying;
+			} else if (!variable->constness) {
+				category = ValueCategory::LValue;
+			} else if (variable->parent == nullptr) {
+				category = ValueCategory::Uniform;
+			}
+			break;
 		}
+		case ASTType::Operator:
+			type = TypeOperator((OperatorNode*)node, &category);
+			break;
+		case ASTType::Function:
+			type = TypeCall(node, &category);
+			break;
+	}
 
-		if (right->nodeType == ASTType::Variable) {
-			StringNode* rName = (StringNode*)right->branches[0];
-			Symbol* symbol = symbolTable->GetSymbol(rName->string);
+	node->typeId   = type ? type->id : ~0u;
+	node->category = category;
 
-			if (symbol->type != SymbolType::Variable) {
-				//TODO: error
-				HC_ASSERT(false);
-			}
+	return type;
+}
+
+Type* Semantic::TypeOperator(OperatorNode* node, ValueCategory* category) {
+	ASTNode* left  = node->branches[0];
+	ASTNode* right = node->branches.GetSize() > 1 ? node->branches[1] : nullptr;
+	Type*    type  = TypeExpression(left);
+
+	if (IsAssignment(node->type)) {
+		if (right)
+			TypeExpression(right);
+
+		// Like C the result is the assigned value, not the variable
+		*category = ValueCategory::Varying;
+
+		return type;
+	}
+
+	if (node->type == OperatorType::Dot) {
+		*category = left->category;
+
+		// The right operand names the member or the components, it isn't an expression
+		return right && right->nodeType == ASTType::Variable ? TypeMember(type, ((StringNode*)right->branches[0])->name) : nullptr;
+	}
+
+	Type* rightType = right ? TypeExpression(right) : nullptr;
 
-			SymbolVariable* smbl = (SymbolVariable*)symbol;
+	if (node->type == OperatorType::OpSqBracketOpen && right) {
+		*category = left->category == ValueCategory::LValue ? ValueCategory::LValue : Combine(left->category, right->category);
 
-			rConstant = smbl->initialValue;
-		} else if (right->nodeType == ASTType::Function) {
-			rConstant = nullptr;
-		} else if (right->nodeType == ASTType::Constant) {
-			rConstant = (ConstantNode*)right;
-		}  else {
-			//TODO: error
-			HC_ASSERT(false);
+		if (type == nullptr || !IsInteger(rightType))
+			return nullptr;
+
+		if (type->type == Type::Vec)
+			return ((TypeVec*)type)->component;
+
+		// Indexing a matrix gives a column
+		return type->type == Type::Mat ? typeTable->MakeTypeVec(PrimitiveType::Vec4) : nullptr;
+	}
+
+	// OpInc and OpDec have no typing rule of their own, an untyped result doesn't mean the operands don't fit
+	bool typed = node->type != OperatorType::OpInc && node->type != OperatorType::OpDec;
+
+	if (right == nullptr) {
+		Type* result = TypeUnary(node->type, type);
+
+		*category = Combine(left->category, left->category);
+
+		if (result == nullptr && type && typed) {
+			Compiler::Log(node->loc, NameTable::Invalid, HC_ERROR_SEMANTIC_INVALID_OPERAND, type->name.str);
+			typeErrors++;
 		}
 
-		if (rConstant == nullptr) return nullptr;
+		return result;
+	}
+
+	Type* result = TypeBinary(node->type, type, rightType);
+
+	*category = Combine(left->category, right->category);
+
+	if (result == nullptr && type && rightType && typed) {
+		Compiler::Log(node->loc, NameTable::Invalid, HC_ERROR_SEMANTIC_INVALID_OPERANDS, type->name.str, rightType->name.str);
+		typeErrors++;
+	}
+
+	return result;
+}
+
+Type* Semantic::TypeCall(ASTNode* node, ValueCategory* category) {
+	ValueCategory args = ValueCategory::Constant;
+
+	for (uint64 i = 1; i < node->branches.GetSize(); i++) {
+		TypeExpression(node->branches[i]);
+
+		args = Combine(args, node->branches[i]->category);
+	}
+
+	StringNode*   name = (StringNode*)node->branches[0];
+	PrimitiveType type = GetConstructor(name->name);
+
+	*category = args;
+
+	switch (type) {
+		case PrimitiveType::Int:
+		case PrimitiveType::Float:
+			return typeTable->MakeTypeScalar(type, 2);
+		case PrimitiveType::Vec2:
+		case PrimitiveType::Vec3:
+		case PrimitiveType::Vec4:
+			return typeTable->MakeTypeVec(type);
+		case PrimitiveType::Mat4:
+			return typeTable->MakeTypeMat(type);
+	}
+
+	// A function can read any global or input, so the result isn't known to be the same everywhere
+	*category = ValueCategory::Varying;
+
+	Symbol* symbol = symbolTable->GetSymbol(name->name);
+
+	if (symbol == nullptr || symbol->type != SymbolType::Function)
+		return nullptr;
+
+	const SymbolFunction::Overload* overload = ((SymbolFunction*)symbol)->GetOverload((uint32)node->branches.GetSize() - 1);
 
+	return overload ? overload->returnType : nullptr;
+}
 
+Type* Semantic::TypeConstant(const ConstantValue& value) {
+	switch (value.type) {
+		case ConstantType::Int:
+			return typeTable->MakeTypeScalar(PrimitiveType::Int, 1);
+		case ConstantType::Uint:
+			return typeTable->MakeTypeScalar(PrimitiveType::Int, 0);
+		case ConstantType::Float:
+			return typeTable->MakeTypeScalar(PrimitiveType::Float, 2);
+		case ConstantType::Vec2:
+			return typeTable->MakeTypeVec(PrimitiveType::Vec2);
+		case ConstantType::Vec3:
+			return typeTable->MakeTypeVec(PrimitiveType::Vec3);
+		case ConstantType::Vec4:
+			return typeTable->MakeTypeVec(PrimitiveType::Vec4);
+		case ConstantType::Mat4:
+			return typeTable->MakeTypeMat(PrimitiveType::Mat4);
 	}
+
+	return nullptr;
 }
 
-ASTNode* Semantic::ExecuteOperator(OperatorType op, ASTNode* operand) {
+Type* Semantic::TypeMember(Type* type, NameId name) {
+	if (type == nullptr)
+		return nullptr;
+
+	if (type->type == Type::Struct) {
+		TypeStruct* strct = (TypeStruct*)type;
+		uint32      index = strct->GetMember(name);
+
+		return index == ~0u ? nullptr : strct->elements[index];
+	}
+
+	if (type->type != Type::Vec)
+		return nullptr;
+
+	// Which components are valid is checked when a constant is swizzled
+	switch (NameTable::Get(name).length) {
+		case 1:
+			return ((TypeVec*)type)->component;
+		case 2:
+			return typeTable->MakeTypeVec(PrimitiveType::Vec2);
+		case 3:
+			return typeTable->MakeTypeVec(PrimitiveType::Vec3);
+		case 4:
+			return typeTable->MakeTypeVec(PrimitiveType::Vec4);
+	}
+
 	return nullptr;
+}
+
+Type* Semantic::TypeBinary(OperatorType op, Type* left, Type* right) {
+	if (left == nullptr || right == nullptr)
+		return nullptr;
+
+	bool scalars = left->type == Type::Scalar && right->type == Type::Scalar;
+
+	switch (op) {
+		case OperatorType::OpAnd:
+		case OperatorType::OpOr:
+		case OperatorType::OpLess:
+		case OperatorType::OpGreater:
+		case OperatorType::OpLessEq:
+		case OperatorType::OpGreaterEq:
+			return scalars ? typeTable->MakeTypeScalar(PrimitiveType::Int, 1) : nullptr;
+		case OperatorType::OpEqual:
+		case OperatorType::OpNotEqual:
+			// Vectors and matrices compare whole
+			return scalars || (left == right && (left->type == Type::Vec || left->type == Type::Mat)) ? typeTable->MakeTypeScalar(PrimitiveType::Int, 1) : nullptr;
+		case OperatorType::OpLeftShift:
+		case OperatorType::OpRightShift:
+			return IsInteger(left) && IsInteger(right) ? Promote(left) : nullptr;
+		case OperatorType::OpBitAnd:
+		case OperatorType::OpBitOr:
+		case OperatorType::OpBitXor:
+			return IsInteger(left) && IsInteger(right) ? TypeArithmetic(left, right) : nullptr;
+		case OperatorType::OpAdd:
+		case OperatorType::OpSub:
+		case OperatorType::OpMul:
+		case OperatorType::OpDiv:
+			break;
+		default:
+			return nullptr;
+	}
+
+	if (scalars)
+		return TypeArithmetic(left, right);
+
+	bool mul = op == OperatorType::OpMul;
+
+	if (left->type == Type::Mat || right->type == Type::Mat) {
+		if (left == right)
+			return op != OperatorType::OpDiv ? left : nullptr;
+
+		if (left->type == Type::Mat && right->type == Type::Scalar && (mul || op == OperatorType::OpDiv))
+			return left;
+
+		if (left->type == Type::Scalar && mul)
+			return right;
+
+		// mat * vec and vec * mat, the vector has to match the matrix size
+		Type* vec = left->type == Type::Vec ? left : right->type == Type::Vec ? right : nullptr;
+
+		if (mul && vec && ((TypeVec*)vec)->components == ((TypeMat*)(left->type == Type::Mat ? left : right))->rows)
+			return vec;
+
+		return nullptr;
+	}
+
+	// Scalars are broadcast to every component
+	if (left->type == Type::Vec && (left == right || right->type == Type::Scalar))
+		return left;
+
+	if (right->type == Type::Vec && left->type == Type::Scalar)
+		return right;
+
+	return nullptr;
+}
+
+Type* Semantic::TypeUnary(OperatorType op, Type* operand) {
+	if (operand == nullptr)
+		return nullptr;
+
+	switch (op) {
+		case OperatorType::OpNegate:
+			if (operand->type == Type::Vec || operand->type == Type::Mat)
+				return operand;
+
+			return operand->type == Type::Scalar ? Promote(operand) : nullptr;
+		case OperatorType::OpBitNot:
+			return IsInteger(operand) ? Promote(operand) : nullptr;
+		case OperatorType::OpNot:
+			return operand->type == Type::Scalar ? typeTable->MakeTypeScalar(PrimitiveType::Int, 1) : nullptr;
+	}
+
+	return nullptr;
+}
+
+Type* Semantic::TypeArithmetic(Type* left, Type* right) {
+	left  = Promote(left);
+	right = Promote(right);
+
+	if (((TypeScalar*)left)->scalarType == TypeScalar::Float || ((TypeScalar*)right)->scalarType == TypeScalar::Float)
+		return typeTable->MakeTypeScalar(PrimitiveType::Float, 2);
+
+	// Both are 32 bits after promotion, mixing signed and unsigned gives unsigned
+	return typeTable->MakeTypeScalar(PrimitiveType::Int, ((TypeScalar*)left)->sign & ((TypeScalar*)right)->sign);
+}
+
+Type* Semantic::Promote(Type* scalar) {
+	TypeScalar* type = (TypeScalar*)scalar;
+
+	// Bytes and shorts of either sign fit in an int
+	return type->scalarType == TypeScalar::Int && type->bits < 32 ? typeTable->MakeTypeScalar(PrimitiveType::Int, 1) : scalar;
 }
\ No newline at end of file
@@ -24,9 +24,9 @@ SOFTWARE
 
 #include "sourcefile.h"
 
-SourceFile::SourceFile() : size(0), filename() {}
+SourceFile::SourceFile() : size(0), filename(), id(NameTable::Invalid) {}
 
-SourceFile::SourceFile(const String& filename) : size(0), filename(filename) {
+SourceFile::SourceFile(const String& filename) : size(0), filename(filename), id(NameTable::Add(filename)) {
     byte* data = FileUtils::LoadFile(filename, &size);
 
     if (data == nullptr) {
@@ -37,4 +37,6 @@ SourceFile::SourceFile(const String& filename) : size(0), filename(filename) {
     text = String((char* const)data, size);
 
 
-}
\ No newline at end of file
+}
+
+SourceFile::SourceFile(const String& filename, const String& text) : size(text.length), text(text), filename(filename), id(NameTable::Add(filename)) {}
\ No newline at end of file
@@ -27,6 +27,7 @@ SOFTWARE
 #include <util/file.h>
 #include <util/string.h>
 #include <util/list.h>
+#include <core/compiler/misc/nametable.h>
 
 class SourceFile {
 private:
@@ -35,9 +36,11 @@ private:
 public:
     String text;
     String filename;
+    NameId id; // Interned filename, kept by locations that outlive the file
 
     SourceFile();
     SourceFile(const String& filename);
+    SourceFile(const String& filename, const String& text); // Source that doesn't come from a file, e.g defines from the command line
 
     uint64 GetSize() const { return size; }
     uint64 GetLength() const { return text.length; }
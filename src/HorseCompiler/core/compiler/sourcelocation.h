@@ -40,4 +40,20 @@ public:
     SourceLocation(SourceFile* file, uint64 index, int64 line, int64 column) : line(line), column(column), index(index), file(file) {}
 
 
+};
+
+// Location kept by the AST and symbols, it doesn't point into a token or source file so the
+// token buffer can be released once the tree is built
+class CompactLocation {
+public:
+    NameId file;
+    int32 line;
+    int32 column;
+
+    CompactLocation() : file(NameTable::Invalid), line(-1), column(-1) {}
+    CompactLocation(NameId file, int32 line, int32 column) : file(file), line(line), column(column) {}
+    CompactLocation(const SourceLocation& loc) : file(loc.file ? loc.file->id : NameTable::Invalid), line((int32)loc.line), column((int32)loc.column) {}
+
+    bool IsValid() const { return line >= 0; }
+    const char* GetFilename() const { return file == NameTable::Invalid ? "" : NameTable::Get(file).str; }
 };
\ No newline at end of file
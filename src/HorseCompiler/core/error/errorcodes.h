@@ -59,6 +59,8 @@ SOFTWARE
 #define HC_ERROR_SYNTAX_EOL                                   HC_ERROR_SYNTAX(0x0E)
 #define HC_ERROR_SYNTAX_INVALID_OPERANDS                      HC_ERROR_SYNTAX(0x0F)
 #define HC_ERROR_SYNTAX_ILLEGAL_TYPENAME                      HC_ERROR_SYNTAX(0x10)
+#define HC_ERROR_SYNTAX_INVALID_LITERAL                       HC_ERROR_SYNTAX(0x11)
+#define HC_ERROR_SYNTAX_LITERAL_OUT_OF_RANGE                  HC_ERROR_SYNTAX(0x12)
 
 #define HC_ERROR_SEMANTIC(code)                               (HC_ERROR_SEMANTIC_PREFIX | (code & 0xFFF))
 #define HC_ERROR_SEMANTIC_TYPE_FOLLOWED_BY_TYPE               HC_ERROR_SEMANTIC(0x00)
@@ -68,3 +70,15 @@ SOFTWARE
 #define HC_ERROR_SEMANTIC_SYMBOL_REDEFINITION                 HC_ERROR_SEMANTIC(0x04)
 #define HC_WARN_SEMANTIC_PARENT_SCOPE_SYMBOL_REDEFINITION     HC_ERROR_SEMANTIC(0x05)
 #define HC_WARN_SEMANTIC_SYMBOL_REDEFINITION                  HC_ERROR_SEMANTIC(0x06)
+#define HC_ERROR_SEMANTIC_TYPE_REDEFINITION                   HC_ERROR_SEMANTIC(0x07)
+#define HC_ERROR_SEMANTIC_INVALID_OPERANDS                    HC_ERROR_SEMANTIC(0x08)
+#define HC_ERROR_SEMANTIC_INVALID_OPERAND                     HC_ERROR_SEMANTIC(0x09)
+#define HC_ERROR_SEMANTIC_DIVISION_BY_ZERO                    HC_ERROR_SEMANTIC(0x0A)
+#define HC_ERROR_SEMANTIC_SHIFT_OUT_OF_RANGE                  HC_ERROR_SEMANTIC(0x0B)
+#define HC_ERROR_SEMANTIC_INDEX_OUT_OF_RANGE                  HC_ERROR_SEMANTIC(0x0C)
+#define HC_ERROR_SEMANTIC_INVALID_SWIZZLE                     HC_ERROR_SEMANTIC(0x0D)
+#define HC_ERROR_SEMANTIC_INVALID_CONSTRUCTOR                 HC_ERROR_SEMANTIC(0x0E)
+#define HC_ERROR_SEMANTIC_CONST_ASSIGNMENT                    HC_ERROR_SEMANTIC(0x0F)
+#define HC_ERROR_SEMANTIC_INVALID_CONVERSION                  HC_ERROR_SEMANTIC(0x10)
+#define HC_ERROR_SEMANTIC_INVALID_LAYOUT_PARAMETER            HC_ERROR_SEMANTIC(0x11)
+#define HC_ERROR_SEMANTIC_LOCAL_TYPE                          HC_ERROR_SEMANTIC(0x12)
@@ -25,7 +25,9 @@ SOFTWARE
 #include "log.h"
 #include <stdarg.h>
 #include <stdio.h>
+#include <string.h>
 #include <Windows.h>
+#include <mutex>
 
 #define HC_LOG_COLOR_INFO    0b00001111
 #define HC_LOG_COLOR_DEBUG   0b00001010
@@ -39,58 +41,101 @@ enum class Level {
 	Error
 };
 
-template <Level level>
-void LogInternal(const char* const message, va_list args) {
+static const char* levelNames[]  = { "Info", "Debug", "Warning", "Error" };
+static const uint16 levelColors[] = { HC_LOG_COLOR_INFO, HC_LOG_COLOR_DEBUG, HC_LOG_COLOR_WARNING, HC_LOG_COLOR_ERROR };
+
+// Messages from different threads must not be interleaved
+static std::mutex logMutex;
+
+static thread_local LogBuffer* captureBuffer = nullptr;
+
+void Print(Level level, const char* const text) {
+	std::lock_guard<std::mutex> lock(logMutex);
+
 	CONSOLE_SCREEN_BUFFER_INFO info;
 
 	HANDLE handle = GetStdHandle(STD_OUTPUT_HANDLE);
 	GetConsoleScreenBufferInfo(handle, &info);
 
-	if constexpr (level == Level::Info) {
-		SetConsoleTextAttribute(handle, HC_LOG_COLOR_INFO);
-		printf("Info: ");
-	} else if constexpr (level == Level::Debug) {
-		SetConsoleTextAttribute(handle, HC_LOG_COLOR_DEBUG);
-		printf("Debug: ");
-	} else if constexpr (level == Level::Warning) {
-		SetConsoleTextAttribute(handle, HC_LOG_COLOR_WARNING);
-		printf("Warning: ");
-	} else if constexpr (level == Level::Error) {
-		SetConsoleTextAttribute(handle, HC_LOG_COLOR_ERROR);
-		printf("Error: ");
+	SetConsoleTextAttribute(handle, levelColors[(uint32)level]);
+	printf("%s\n", text);
+
+	SetConsoleTextAttribute(handle, info.wAttributes);
+}
+
+void LogInternal(Level level, const char* const prefix, const char* const message, va_list args) {
+	va_list copy;
+	va_copy(copy, args);
+
+	uint64 prefixLength = strlen(prefix);
+	uint64 length       = prefixLength + vsnprintf(nullptr, 0, message, copy);
+
+	va_end(copy);
+
+	char* text = new char[length + 1];
+
+	memcpy(text, prefix, prefixLength);
+	vsnprintf(text + prefixLength, length - prefixLength + 1, message, args);
+
+	if (captureBuffer) {
+		captureBuffer->messages.push_back({ (uint8)level, String(text, length) });
+		return;
 	}
 
-	vprintf(message, args);
-	printf("\n");
+	Print(level, text);
 
-	SetConsoleTextAttribute(handle, info.wAttributes);
+	delete[] text;
+}
+
+template <Level level>
+void LogInternal(const char* const message, va_list args) {
+	char prefix[32];
+
+	snprintf(prefix, sizeof(prefix), "%s: ", levelNames[(uint32)level]);
+
+	LogInternal(level, prefix, message, args);
 }
 
 template <Level level>
 void LogInternal(const char* const filename, int64 line, int64 column, int64 code, const char* const message, va_list args) {
-	CONSOLE_SCREEN_BUFFER_INFO info;
+	char prefix[1024];
 
-	HANDLE handle = GetStdHandle(STD_OUTPUT_HANDLE);
-	GetConsoleScreenBufferInfo(handle, &info);
+	snprintf(prefix, sizeof(prefix), "%s -> %llu:%llu %s (0x%llx): ", filename, line, column, levelNames[(uint32)level], code);
+
+	LogInternal(level, prefix, message, args);
+}
 
-	if constexpr (level == Level::Info) {
-		SetConsoleTextAttribute(handle, HC_LOG_COLOR_INFO);
-		printf("%s -> %llu:%llu Info (0x%llx): ", filename, line, column, code);
-	} else if constexpr (level == Level::Debug) {
-		SetConsoleTextAttribute(handle, HC_LOG_COLOR_DEBUG);
-		printf("%s -> %llu:%llu Debug (0x%llx): ", filename, line, column, code);
-	} else if constexpr (level == Level::Warning) {
-		SetConsoleTextAttribute(handle, HC_LOG_COLOR_WARNING);
-		printf("%s -> %llu:%llu Warning (0x%llx): ", filename, line, column, code);
-	} else if constexpr (level == Level::Error) {
-		SetConsoleTextAttribute(handle, HC_LOG_COLOR_ERROR);
-		printf("%s -> %llu:%llu Error (0x%llx): ", filename, line, column, code);
+bool LogBuffer::HasErrors() const {
+	for (const Message& message : messages) {
+		if (message.level == (uint8)Level::Error)
+			return true;
 	}
 
-	vprintf(message, args);
-	printf("\n");
+	return false;
+}
 
-	SetConsoleTextAttribute(handle, info.wAttributes);
+void Log::BeginCapture(LogBuffer* buffer) {
+	buffer->outer = captureBuffer;
+	captureBuffer = buffer;
+}
+
+void Log::EndCapture() {
+	LogBuffer* buffer = captureBuffer;
+
+	if (buffer == nullptr)
+		return;
+
+	captureBuffer = buffer->outer;
+	buffer->outer = nullptr;
+}
+
+void Log::Replay(const LogBuffer& buffer) {
+	for (const LogBuffer::Message& message : buffer.messages) {
+		if (captureBuffer)
+			captureBuffer->messages.push_back(message);
+		else
+			Print((Level)message.level, message.text.str);
+	}
 }
 
 CompilerCode Log::codes[CompilerCode::COUNT];
@@ -25,9 +25,35 @@ SOFTWARE
 #pragma once
 
 #include <core/def.h>
+#include <util/string.h>
+
+#include <vector>
+
+// Messages kept by Log::BeginCapture instead of being printed
+class LogBuffer {
+public:
+	struct Message {
+		uint8  level;
+		String text;
+	};
+
+	std::vector<Message> messages;
+
+	// Capture that was active when this one began, it's restored by EndCapture
+	LogBuffer* outer = nullptr;
+
+	bool HasErrors() const;
+};
 
 class Log {
 public:
+	// Messages logged by the calling thread are stored in buffer until EndCapture. Work done in parallel
+	// captures its messages and prints them with Replay in a fixed order, so the output doesn't depend on timing.
+	// Captures nest, Replay inside a capture adds the messages to the enclosing buffer instead of printing them
+	static void BeginCapture(LogBuffer* buffer);
+	static void EndCapture();
+	static void Replay(const LogBuffer& buffer);
+
 	static void Info(const char* const message, ...);
 	static void Info(int64 line, int64 column, const char* const filename, int64 code, const char* const message, ...);
 	static void Debug(const char* const message, ...);
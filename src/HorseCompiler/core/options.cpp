@@ -22,4 +22,141 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE
 */
 
-#include "options.h"
\ No newline at end of file
+#include "options.h"
+#include <core/log/log.h>
+
+#include <stdlib.h>
+
+ShaderStage Options::stage = ShaderStage::Vertex;
+
+String       Options::inputFile("");
+List<String> Options::includeDirs;
+List<String> Options::defines;
+
+bool   Options::dependencyFile = false;
+String Options::dependencyFilename("");
+String Options::dependencyTarget("");
+bool   Options::dependencyPhony = false;
+String Options::includeGraphFilename("");
+
+String Options::createPchFilename("");
+String Options::includePchFilename("");
+
+String Options::permutationFilename("");
+uint32 Options::numThreads = 0;
+bool   Options::prunePermutations = false;
+String Options::permutationMapFilename("");
+String Options::entryPoint("main");
+
+String Options::astCacheDir("");
+bool   Options::lazyBodies = false;
+bool   Options::timePasses = false;
+
+String      Options::reflectionFilename("");
+LayoutRules Options::uniformLayout = LayoutRules::Std140;
+bool        Options::packUniforms = false;
+bool        Options::keepInterface = false;
+
+bool Options::Parse(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        TmpString arg(argv[i]);
+
+        bool hasValue = i + 1 < argc;
+
+        if (arg.StartsWith("-I")) {
+            if (arg.length > 2) {
+                includeDirs.PushBack(arg.str + 2);
+            } else if (hasValue) {
+                includeDirs.PushBack(argv[++i]);
+            } else {
+                Log::Error("missing directory after '-I'");
+                return false;
+            }
+        } else if (arg.StartsWith("-D")) {
+            if (arg.length > 2) {
+                defines.PushBack(arg.str + 2);
+            } else if (hasValue) {
+                defines.PushBack(argv[++i]);
+            } else {
+                Log::Error("missing macro after '-D'");
+                return false;
+            }
+        } else if (arg == "-MD") {
+            dependencyFile = true;
+        } else if (arg == "-MP") {
+            dependencyPhony = true;
+        } else if (arg == "--prune-permutations") {
+            prunePermutations = true;
+        } else if (arg == "--lazy-bodies") {
+            lazyBodies = true;
+        } else if (arg == "--time-passes") {
+            timePasses = true;
+        } else if (arg == "--pack-uniforms") {
+            packUniforms = true;
+        } else if (arg == "--keep-interface") {
+            keepInterface = true;
+        } else if (arg == "-MF" || arg == "-MT" || arg == "--include-graph" || arg == "--create-pch" || arg == "--include-pch" || arg == "--permutations" || arg == "-j" || arg == "--permutation-map" || arg == "--entry" || arg == "--ast-cache" || arg == "--reflection" || arg == "--uniform-layout") {
+            if (!hasValue) {
+                Log::Error("missing argument after '%s'", arg.str);
+                return false;
+            }
+
+            if (arg == "-MF") {
+                dependencyFile     = true;
+                dependencyFilename = argv[++i];
+            } else if (arg == "-MT") {
+                dependencyTarget = argv[++i];
+            } else if (arg == "--create-pch") {
+                createPchFilename = argv[++i];
+            } else if (arg == "--include-pch") {
+                includePchFilename = argv[++i];
+            } else if (arg == "--permutations") {
+                permutationFilename = argv[++i];
+            } else if (arg == "-j") {
+                numThreads = (uint32)atoi(argv[++i]);
+            } else if (arg == "--permutation-map") {
+                prunePermutations      = true;
+                permutationMapFilename = argv[++i];
+            } else if (arg == "--entry") {
+                entryPoint = argv[++i];
+            } else if (arg == "--ast-cache") {
+                astCacheDir = argv[++i];
+            } else if (arg == "--reflection") {
+                reflectionFilename = argv[++i];
+            } else if (arg == "--uniform-layout") {
+                TmpString rules(argv[++i]);
+
+                if (rules == "std140") {
+                    uniformLayout = LayoutRules::Std140;
+                } else if (rules == "std430") {
+                    uniformLayout = LayoutRules::Std430;
+                } else {
+                    Log::Error("unknown uniform layout '%s', expected std140 or std430", rules.str);
+                    return false;
+                }
+            } else {
+                includeGraphFilename = argv[++i];
+            }
+        } else if (arg[0] == '-') {
+            Log::Error("unknown option '%s'", arg.str);
+            return false;
+        } else {
+            inputFile = arg;
+        }
+    }
+
+    if (inputFile.length == 0) {
+        Log::Error("no input file");
+        return false;
+    }
+
+    if (dependencyFilename.length == 0) {
+        dependencyFilename = inputFile + ".d";
+    }
+
+    if (dependencyTarget.length == 0) {
+        dependencyTarget = inputFile + ".spv";
+    }
+
+    return true;
+}
\ No newline at end of file
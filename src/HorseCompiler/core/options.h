@@ -24,6 +24,10 @@ SOFTWARE
 
 #pragma once
 
+#include <util/string.h>
+#include <util/list.h>
+#include <core/compiler/misc/memorylayout.h>
+
 enum class ShaderStage {
     Vertex,
     Fragment
@@ -33,4 +37,33 @@ class Options {
 public:
     static ShaderStage stage;
 
+    static String       inputFile;
+    static List<String> includeDirs; // -I<dir>
+    static List<String> defines;     // -D<name>[=<value>]
+
+    static bool   dependencyFile;       // -MD, write a make style dependency file
+    static String dependencyFilename;   // -MF <file>, defaults to <input>.d
+    static String dependencyTarget;     // -MT <target>, defaults to <input>.spv
+    static bool   dependencyPhony;      // -MP, add phony targets for all headers
+    static String includeGraphFilename; // --include-graph <file>, write the include tree as json
+
+    static String createPchFilename;    // --create-pch <file>, preprocess the input as a header and write a precompiled header
+    static String includePchFilename;   // --include-pch <file>, use a precompiled header as prefix of the input
+
+    static String permutationFilename;     // --permutations <file>, compile every define set in the file (one per line)
+    static uint32 numThreads;              // -j <n>, threads used for parsing, semantic analysis and permutations, 0 uses every hardware thread
+    static bool   prunePermutations;       // --prune-permutations, group permutations that produce identical code
+    static String permutationMapFilename;  // --permutation-map <file>, write which class every permutation belongs to, implies --prune-permutations
+    static String entryPoint;              // --entry <name>, defaults to main
+
+    static String astCacheDir; // --ast-cache <dir>, reuse parsed trees keyed by the hash of the preprocessed source
+    static bool   lazyBodies;  // --lazy-bodies, only parse function bodies reachable from the entry point
+    static bool   timePasses;  // --time-passes, print the time and node counts of every phase and pass
+
+    static String      reflectionFilename; // --reflection <file>, write the inputs, outputs and uniform layouts as a binary blob
+    static LayoutRules uniformLayout;      // --uniform-layout <std140|std430>, rules uniform buffers are laid out with, defaults to std140
+    static bool        packUniforms;       // --pack-uniforms, reorder the members of inline uniform blocks to minimize padding
+    static bool        keepInterface;      // --keep-interface, keep inputs, outputs, uniforms and samplers the entry point doesn't use
+
+    static bool Parse(int argc, char** argv);
 };
\ No newline at end of file
@@ -0,0 +1,467 @@
+/*
+MIT License
+
+Copyright (c) 2021 Jesper
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE
+*/
+
+#include "precompiledheader.h"
+#include "preprocessor.h"
+
+#include <util/file.h>
+#include <util/util.h>
+
+#include <string.h>
+#include <vector>
+
+class StringTable {
+public:
+	std::vector<char>                  data;
+	std::unordered_map<String, uint32> offsets;
+
+	uint32 Add(const String& string) {
+		auto it = offsets.find(string);
+
+		if (it != offsets.end())
+			return it->second;
+
+		uint32 offset = (uint32)data.size();
+
+		data.insert(data.end(), string.str, string.str + string.length);
+		data.push_back(0);
+
+		offsets.emplace(string, offset);
+
+		return offset;
+	}
+};
+
+uint64 Align(uint64 offset) {
+	return (offset + 7) & ~7ull;
+}
+
+String MakeString(const char* str, uint64 length) {
+	if (length == 0)
+		return String("");
+
+	char* tmp = new char[length + 1];
+
+	memcpy(tmp, str, length);
+	tmp[length] = 0;
+
+	return std::move(String(tmp, length));
+}
+
+bool HashFile(const String& filename, uint64* size, uint64* hash) {
+	byte* data = FileUtils::LoadFile(filename, size);
+
+	if (data == nullptr)
+		return false;
+
+	*hash = HashUtils::FNV1a(data, *size);
+
+	delete[] data;
+
+	return true;
+}
+
+String JoinTokens(const Tokens& tokens) {
+	String res("");
+
+	for (uint64 i = 0; i < tokens.GetSize(); i++) {
+		if (i > 0)
+			res.Append(" ");
+
+		res.Append(tokens[i].string);
+	}
+
+	return res;
+}
+
+bool PrecompiledHeader::Write(const String& filename, const Tokens& tokens, const PreProcessor& preProcessor) {
+	if (preProcessor.root == nullptr) {
+		Log::Error("can't create precompiled header \"%s\", nothing has been preprocessed", filename.str);
+		return false;
+	}
+
+	StringTable                        strings;
+	List<FileRecord>                   files;
+	List<TokenRecord>                  tokenRecords;
+	List<DefineRecord>                 defines;
+	List<uint32>                       once;
+	List<PredefineRecord>              predefines;
+	std::unordered_map<String, uint32> fileIndices;
+
+	List<std::pair<const FileNode*, uint32>> stack;
+
+	stack.PushBack({ preProcessor.root, ~0u });
+
+	while (stack.GetSize() > 0) {
+		auto [node, parent] = stack.Back();
+		stack.PopBack();
+
+		FileRecord record;
+
+		record.name   = strings.Add(node->name);
+		record.parent = parent;
+
+		if (!HashFile(node->name, &record.size, &record.hash)) {
+			Log::Error("failed to open file \"%s\"", node->name.str);
+			return false;
+		}
+
+		uint32 index = (uint32)files.GetSize();
+
+		files.PushBack(record);
+		fileIndices.emplace(node->name, index);
+
+		for (uint64 i = node->files.GetSize(); i > 0; i--) {
+			stack.PushBack({ node->files[i - 1], index });
+		}
+	}
+
+	auto AddTokens = [&](const Tokens& list) {
+		for (const Token& t : list) {
+			TokenRecord record;
+
+			auto it = fileIndices.find(t.loc.file->filename);
+
+			// Values of -D defines are lexed from a string, not from a file in the include tree
+			bool commandLine = it == fileIndices.end() && t.loc.file->filename == "<command line>";
+
+			if (it == fileIndices.end() && !commandLine) {
+				// Shouldn't happen, every lexed file is in the include tree
+				Log::Error("precompiled header: \"%s\" isn't part of the include tree", t.loc.file->filename.str);
+				return false;
+			}
+
+			record.string        = strings.Add(t.string);
+			record.length        = (uint32)t.string.length;
+			record.file          = commandLine ? CommandLine : it->second;
+			record.index         = (uint32)t.loc.index;
+			record.line          = (int32)t.loc.line;
+			record.column        = (int32)t.loc.column;
+			record.type          = (uint16)t.type;
+			record.keyword       = (uint8)t.keyword;
+			record.primitiveType = (uint8)t.primitiveType;
+			record.operatorType  = (uint8)t.operatorType;
+			record.flags         = (t.trailingSpace ? FlagTrailingSpace : 0) | (t.isString ? FlagIsString : 0);
+			record.reserved      = 0;
+
+			tokenRecords.PushBack(record);
+		}
+
+		return true;
+	};
+
+	if (!AddTokens(tokens))
+		return false;
+
+	uint32 numPrefixTokens = (uint32)tokenRecords.GetSize();
+
+	for (const auto& [name, def] : preProcessor.defines) {
+		DefineRecord record;
+
+		record.name       = strings.Add(name);
+		record.firstToken = (uint32)tokenRecords.GetSize();
+		record.numTokens  = (uint32)def.GetSize();
+		record.reserved   = 0;
+
+		if (!AddTokens(def))
+			return false;
+
+		defines.PushBack(record);
+	}
+
+	for (const String& file : preProcessor.includedFiles) {
+		auto it = fileIndices.find(file);
+
+		if (it != fileIndices.end())
+			once.PushBack(it->second);
+	}
+
+	for (const auto& [name, def] : preProcessor.predefines) {
+		PredefineRecord record;
+
+		record.name  = strings.Add(name);
+		record.value = strings.Add(JoinTokens(def));
+
+		predefines.PushBack(record);
+	}
+
+	Header header;
+
+	header.magic            = Magic;
+	header.version          = Version;
+	header.numFiles         = (uint32)files.GetSize();
+	header.numTokens        = (uint32)tokenRecords.GetSize();
+	header.numPrefixTokens  = numPrefixTokens;
+	header.numDefines       = (uint32)defines.GetSize();
+	header.numOnce          = (uint32)once.GetSize();
+	header.numPredefines    = (uint32)predefines.GetSize();
+	header.filesOffset      = Align(sizeof(Header));
+	header.tokensOffset     = Align(header.filesOffset + sizeof(FileRecord) * files.GetSize());
+	header.definesOffset    = Align(header.tokensOffset + sizeof(TokenRecord) * tokenRecords.GetSize());
+	header.onceOffset       = Align(header.definesOffset + sizeof(DefineRecord) * defines.GetSize());
+	header.predefinesOffset = Align(header.onceOffset + sizeof(uint32) * once.GetSize());
+	header.stringsOffset    = Align(header.predefinesOffset + sizeof(PredefineRecord) * predefines.GetSize());
+	header.stringsSize      = strings.data.size();
+
+	uint64 size = header.stringsOffset + header.stringsSize;
+	byte*  data = new byte[size];
+
+	memset(data, 0, size);
+	memcpy(data, &header, sizeof(Header));
+
+	if (files.GetSize() > 0)
+		memcpy(data + header.filesOffset, &files[0], sizeof(FileRecord) * files.GetSize());
+
+	if (tokenRecords.GetSize() > 0)
+		memcpy(data + header.tokensOffset, &tokenRecords[0], sizeof(TokenRecord) * tokenRecords.GetSize());
+
+	if (defines.GetSize() > 0)
+		memcpy(data + header.definesOffset, &defines[0], sizeof(DefineRecord) * defines.GetSize());
+
+	if (once.GetSize() > 0)
+		memcpy(data + header.onceOffset, &once[0], sizeof(uint32) * once.GetSize());
+
+	if (predefines.GetSize() > 0)
+		memcpy(data + header.predefinesOffset, &predefines[0], sizeof(PredefineRecord) * predefines.GetSize());
+
+	if (strings.data.size() > 0)
+		memcpy(data + header.stringsOffset, strings.data.data(), strings.data.size());
+
+	bool res = FileUtils::WriteFile(filename, data, size);
+
+	delete[] data;
+
+	if (!res) {
+		Log::Error("failed to write precompiled header \"%s\"", filename.str);
+	}
+
+	return res;
+}
+
+bool PrecompiledHeader::Validate(const Header* header, const byte* data, uint64 size) {
+	// Written so a corrupt offset or count can't overflow
+	auto FitsIn = [size](uint64 offset, uint64 count, uint64 elementSize) {
+		return offset <= size && count <= (size - offset) / elementSize;
+	};
+
+	bool valid = size >= sizeof(Header) && header->magic == Magic && header->version == Version;
+
+	valid = valid && FitsIn(header->filesOffset, header->numFiles, sizeof(FileRecord));
+	valid = valid && FitsIn(header->tokensOffset, header->numTokens, sizeof(TokenRecord));
+	valid = valid && FitsIn(header->definesOffset, header->numDefines, sizeof(DefineRecord));
+	valid = valid && FitsIn(header->onceOffset, header->numOnce, sizeof(uint32));
+	valid = valid && FitsIn(header->predefinesOffset, header->numPredefines, sizeof(PredefineRecord));
+	valid = valid && FitsIn(header->stringsOffset, header->stringsSize, 1);
+	valid = valid && header->numFiles > 0 && header->numPrefixTokens <= header->numTokens;
+
+	// With a null terminator at the end every offset inside the strings gives a terminated string
+	valid = valid && header->stringsSize > 0 && data[header->stringsOffset + header->stringsSize - 1] == 0;
+
+	if (!valid)
+		return false;
+
+	const FileRecord*      files      = (const FileRecord*)(data + header->filesOffset);
+	const TokenRecord*     tokens     = (const TokenRecord*)(data + header->tokensOffset);
+	const DefineRecord*    defines    = (const DefineRecord*)(data + header->definesOffset);
+	const uint32*          once       = (const uint32*)(data + header->onceOffset);
+	const PredefineRecord* predefines = (const PredefineRecord*)(data + header->predefinesOffset);
+
+	for (uint32 i = 0; i < header->numFiles; i++) {
+		if (files[i].name >= header->stringsSize || (files[i].parent != ~0u && files[i].parent >= i))
+			return false;
+	}
+
+	for (uint32 i = 0; i < header->numTokens; i++) {
+		const TokenRecord& record = tokens[i];
+
+		if ((uint64)record.string + record.length >= header->stringsSize)
+			return false;
+
+		if (record.file != CommandLine && record.file >= header->numFiles)
+			return false;
+	}
+
+	for (uint32 i = 0; i < header->numDefines; i++) {
+		if (defines[i].name >= header->stringsSize || (uint64)defines[i].firstToken + defines[i].numTokens > header->numTokens)
+			return false;
+	}
+
+	for (uint32 i = 0; i < header->numOnce; i++) {
+		if (once[i] >= header->numFiles)
+			return false;
+	}
+
+	for (uint32 i = 0; i < header->numPredefines; i++) {
+		if (predefines[i].name >= header->stringsSize || predefines[i].value >= header->stringsSize)
+			return false;
+	}
+
+	return true;
+}
+
+bool PrecompiledHeader::Load(const String& filename, PreProcessor& preProcessor) {
+	uint64      size = 0;
+	const byte* data = FileUtils::MapFile(filename, &size);
+
+	if (data == nullptr) {
+		Log::Error("failed to open precompiled header \"%s\"", filename.str);
+		return false;
+	}
+
+	const Header* header = (const Header*)data;
+
+	if (!Validate(header, data, size)) {
+		Log::Error("\"%s\" is not a valid precompiled header", filename.str);
+		FileUtils::UnmapFile(data, size);
+		return false;
+	}
+
+	const FileRecord*      files      = (const FileRecord*)(data + header->filesOffset);
+	const TokenRecord*     tokens     = (const TokenRecord*)(data + header->tokensOffset);
+	const DefineRecord*    defines    = (const DefineRecord*)(data + header->definesOffset);
+	const uint32*          once       = (const uint32*)(data + header->onceOffset);
+	const PredefineRecord* predefines = (const PredefineRecord*)(data + header->predefinesOffset);
+	const char*            strings    = (const char*)(data + header->stringsOffset);
+
+	// The tokens were preprocessed with the defines given at the time, other defines could select other branches
+	bool sameDefines = header->numPredefines == preProcessor.predefines.GetSize();
+
+	for (uint32 i = 0; i < header->numPredefines && sameDefines; i++) {
+		uint64 loc = preProcessor.predefines.Find(String(strings + predefines[i].name), PreProcessor::FindDefineCmp, 0);
+
+		sameDefines = loc != ~0 && JoinTokens(preProcessor.predefines[loc].second) == strings + predefines[i].value;
+	}
+
+	if (!sameDefines) {
+		Log::Warning("precompiled header \"%s\" is out of date, it was created with other defines. Falling back to \"%s\"", filename.str, strings + files[0].name);
+
+		preProcessor.pchFallback = String(strings + files[0].name);
+
+		FileUtils::UnmapFile(data, size);
+		return true;
+	}
+
+	List<SourceFile*> sourceFiles;
+	List<FileNode*>   nodes;
+
+	for (uint32 i = 0; i < header->numFiles; i++) {
+		const FileRecord& record = files[i];
+		TmpString         name(strings + record.name);
+
+		uint64 fileSize = 0;
+		uint64 hash     = 0;
+
+		if (!HashFile(name, &fileSize, &hash) || fileSize != record.size || hash != record.hash) {
+			Log::Warning("precompiled header \"%s\" is out of date, \"%s\" has changed. Falling back to \"%s\"", filename.str, name.str, strings + files[0].name);
+
+			preProcessor.pchFallback = String(strings + files[0].name);
+
+			for (uint64 j = 0; j < nodes.GetSize(); j++) {
+				delete nodes[j];
+				delete sourceFiles[j];
+			}
+
+			FileUtils::UnmapFile(data, size);
+			return true;
+		}
+
+		SourceFile* source = new SourceFile();
+		FileNode*   node   = new FileNode;
+
+		source->filename = name;
+		source->id       = NameTable::Add(name);
+		node->name       = name;
+		node->parent     = record.parent < i ? nodes[record.parent] : nullptr;
+
+		if (node->parent)
+			node->parent->files.PushBack(node);
+
+		sourceFiles.PushBack(source);
+		nodes.PushBack(node);
+	}
+
+	SourceFile* commandLine = nullptr;
+
+	auto MakeToken = [&](const TokenRecord& record) {
+		Token       t;
+		SourceFile* file = sourceFiles[record.file < header->numFiles ? record.file : 0];
+
+		if (record.file == CommandLine) {
+			if (commandLine == nullptr)
+				commandLine = new SourceFile(String("<command line>"), String(""));
+
+			file = commandLine;
+		}
+
+		t.loc           = SourceLocation(file, record.index, record.line, record.column);
+		t.string        = MakeString(strings + record.string, record.length);
+		t.trailingSpace = (record.flags & FlagTrailingSpace) != 0;
+		t.isString      = (record.flags & FlagIsString) != 0;
+		t.type          = (TokenType)record.type;
+		t.keyword       = (KeywordType)record.keyword;
+		t.primitiveType = (PrimitiveType)record.primitiveType;
+		t.operatorType  = (OperatorType)record.operatorType;
+
+		return t;
+	};
+
+	preProcessor.pchTokens = Tokens();
+	preProcessor.pchTokens.Reserve(header->numPrefixTokens + 1);
+
+	for (uint32 i = 0; i < header->numPrefixTokens; i++) {
+		preProcessor.pchTokens.PushBack(MakeToken(tokens[i]));
+	}
+
+	for (uint32 i = 0; i < header->numDefines; i++) {
+		const DefineRecord& record = defines[i];
+		String              name(strings + record.name);
+		Tokens              def;
+
+		for (uint32 j = record.firstToken; j < record.firstToken + record.numTokens; j++) {
+			def.PushBack(MakeToken(tokens[j]));
+		}
+
+		uint64 loc = preProcessor.defines.Find(name, PreProcessor::FindDefineCmp, 0);
+
+		if (loc != ~0) {
+			preProcessor.defines[loc].second = def;
+		} else {
+			preProcessor.defines.PushBack(std::pair(name, def));
+		}
+	}
+
+	for (uint32 i = 0; i < header->numOnce; i++) {
+		preProcessor.includedFiles.insert(nodes[once[i]]->name);
+	}
+
+	if (preProcessor.pchRoot)
+		DeleteFileNode(preProcessor.pchRoot);
+
+	preProcessor.pchRoot     = nodes[0];
+	preProcessor.pchFallback = "";
+
+	FileUtils::UnmapFile(data, size);
+
+	return true;
+}
@@ -0,0 +1,118 @@
+/*
+MIT License
+
+Copyright (c) 2021 Jesper
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE
+*/
+
+#pragma once
+
+#include <core/def.h>
+#include <util/string.h>
+#include <core/compiler/lexer/token.h>
+
+class PreProcessor;
+
+/** Precompiled header format
+* All offsets are from the start of the file and every section is 8 byte aligned,
+* nothing in the file is a pointer so it can be used directly from a mapping.
+*
+* Header
+* Files:      FileRecord[numFiles], the include tree in pre order. Index 0 is the header itself
+* Tokens:     TokenRecord[numTokens], the preprocessed tokens followed by the tokens of every macro
+* Defines:    DefineRecord[numDefines]
+* Once:       uint32[numOnce], index into Files of every file with #pragma once
+* Predefines: PredefineRecord[numPredefines], the defines given before the header was preprocessed (-D)
+* Strings:    char[stringsSize], every string is null terminated
+*/
+
+class PrecompiledHeader {
+public:
+	static constexpr uint32 Magic   = 0x48435048; // "HPCH"
+	static constexpr uint32 Version = 2;
+
+	struct Header {
+		uint32 magic;
+		uint32 version;
+
+		uint32 numFiles;
+		uint32 numTokens;
+		uint32 numPrefixTokens; // Tokens that belong to the header, the rest are macro definitions
+		uint32 numDefines;
+		uint32 numOnce;
+		uint32 numPredefines;
+
+		uint64 filesOffset;
+		uint64 tokensOffset;
+		uint64 definesOffset;
+		uint64 onceOffset;
+		uint64 predefinesOffset;
+		uint64 stringsOffset;
+		uint64 stringsSize;
+	};
+
+	struct FileRecord {
+		uint32 name;
+		uint32 parent; // ~0 for the root
+		uint64 size;
+		uint64 hash;
+	};
+
+	struct TokenRecord {
+		uint32 string;
+		uint32 length;
+		uint32 file; // CommandLine if it comes from a define given before the header was preprocessed
+		uint32 index;
+		int32  line;
+		int32  column;
+		uint16 type;
+		uint8  keyword;
+		uint8  primitiveType;
+		uint8  operatorType;
+		uint8  flags;
+		uint16 reserved;
+	};
+
+	struct DefineRecord {
+		uint32 name;
+		uint32 firstToken;
+		uint32 numTokens;
+		uint32 reserved;
+	};
+
+	struct PredefineRecord {
+		uint32 name;
+		uint32 value; // The tokens separated by a space
+	};
+
+	static constexpr uint32 CommandLine = ~0u;
+
+	static constexpr uint8 FlagTrailingSpace = 0x01;
+	static constexpr uint8 FlagIsString      = 0x02;
+
+	static bool Write(const String& filename, const Tokens& tokens, const PreProcessor& preProcessor);
+	// Returns false if the file isn't a valid precompiled header. If any of the files it was built from has changed,
+	// or the defines given before it differ, the header it was created from is preprocessed from source instead
+	static bool Load(const String& filename, PreProcessor& preProcessor);
+
+private:
+	// Checks that every section, string offset, token range and index in a mapped file is in range
+	static bool Validate(const Header* header, const byte* data, uint64 size);
+};
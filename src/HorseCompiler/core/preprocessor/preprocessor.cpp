@@ -23,6 +23,8 @@ SOFTWARE
 */
 
 #include "preprocessor.h"
+#include "precompiledheader.h"
+#include "tokencache.h"
 
 #include <util/file.h>
 #include <util/util.h>
@@ -38,13 +40,13 @@ void CorrectIncludeDir(List<String>& includeDir) {
 }
 
 uint64 FindNextNewline(const Tokens& tokens, uint64 index) {
-	uint64        line = tokens[index].loc.line;
-	const String& file = tokens[index].loc.file->filename;
+	uint64            line = tokens[index].loc.line;
+	const SourceFile* file = tokens[index].loc.file;
 
 	for (uint64 i = index; i < tokens.GetSize(); i++) {
 		const SourceLocation& t = tokens[i].loc;
 
-		if (t.line != line || t.file->filename != file)
+		if (t.line != line || t.file != file)
 			return i - 1;
 	}
 
@@ -132,49 +134,18 @@ List<uint64> FindElifs(const Tokens& tokens, uint64 start, uint64 end) {
 	return std::move(elifs);
 }
 
-void RemoveComments(Tokens& tokens) {
-	uint64 index = -1;
-
-	while ((index = tokens.Find('/', Token::CharCmp, index + 1)) != ~0) {
-		char next = tokens[index + 1].string[0];
-
-		if (next == '/') {
-			uint64 newLine = FindNextNewline(tokens, index);
-
-			if (newLine == ~0)
-				newLine = tokens.GetSize() - 1;
-
-			tokens.Remove(index, newLine);
-		} else if (next == '*') {
-			uint64 end = index + 2;
-
-			while ((end = tokens.Find('*', Token::CharCmp, end)) != ~0) {
-				if (tokens[end += 1].string[0] == '/')
-					break;
-			}
-
-			if (end == ~0)
-				end = tokens.GetSize() - 1;
-
-			tokens.Remove(index, end);
-
-			if (index == tokens.GetSize()) break;
-		}
-	}
-}
-
 String MergeList(const Tokens& tokens, uint64 start, uint64 end) {
 	String res("");
 
-	int64  currentLine = tokens[start].loc.line;
-	String currentFile = tokens[start].loc.file->filename;
+	int64             currentLine = tokens[start].loc.line;
+	const SourceFile* currentFile = tokens[start].loc.file;
 
 	for (uint64 i = start; i <= end; i++) {
 		const Token& t = tokens[i];
 
-		if (currentLine < t.loc.line || currentFile != t.loc.file->filename) {
+		if (currentLine < t.loc.line || currentFile != t.loc.file) {
 			currentLine = t.loc.line;
-			currentFile = t.loc.file->filename;
+			currentFile = t.loc.file;
 			res.Append("\n");
 		}
 
@@ -191,20 +162,6 @@ String MergeList(const Tokens& tokens, uint64 start, uint64 end) {
 	return std::move(res);
 }
 
-FileNode* FindCurrentNode(FileNode* nodes, const String& currentFile) {
-	if (nodes->name == currentFile)
-		return nodes;
-
-	for (uint64 i = 0; i < nodes->files.GetSize(); i++) {
-		FileNode* n = FindCurrentNode(nodes->files[i], currentFile);
-
-		if (n)
-			return n;
-	}
-
-	return nullptr;
-}
-
 FileNode* CheckRecursion(FileNode* currentNode, const String& file) {
 	if (currentNode->name == file)
 		return currentNode;
@@ -216,16 +173,149 @@ FileNode* CheckRecursion(FileNode* currentNode, const String& file) {
 	return nullptr;
 }
 
-PreProcessor::PreProcessor(List<String>& includeDir, Compiler* compiler) {
+void DeleteFileNode(FileNode* node) {
+	for (FileNode* n : node->files) {
+		DeleteFileNode(n);
+	}
+
+	delete node;
+}
+
+String EscapeDependency(const String& filename) {
+	String res("");
+
+	for (uint64 i = 0; i < filename.length; i++) {
+		char c = filename[i];
+
+		if (c == ' ' || c == '#') {
+			res.Append("\\");
+		} else if (c == '$') {
+			res.Append("$");
+		}
+
+		char tmp[2] = { c, 0 };
+		res.Append(tmp);
+	}
+
+	return std::move(res);
+}
+
+String EscapeJson(const String& string) {
+	String res("");
+
+	for (uint64 i = 0; i < string.length; i++) {
+		char c = string[i];
+
+		if (c == '"' || c == '\\') {
+			res.Append("\\");
+		}
+
+		char tmp[2] = { c, 0 };
+		res.Append(tmp);
+	}
+
+	return std::move(res);
+}
+
+void WriteJsonNode(const FileNode* node, String& json, const String& indent) {
+	String childIndent = indent + "\t\t";
+
+	json.Append("{\n");
+	json.Append(indent).Append("\t\"file\": \"").Append(EscapeJson(node->name)).Append("\",\n");
+	json.Append(indent).Append("\t\"includes\": [");
+
+	for (uint64 i = 0; i < node->files.GetSize(); i++) {
+		json.Append(i == 0 ? "\n" : ",\n");
+		json.Append(childIndent);
+		WriteJsonNode(node->files[i], json, childIndent);
+	}
+
+	if (node->files.GetSize() > 0) {
+		json.Append("\n").Append(indent).Append("\t");
+	}
+
+	json.Append("]\n").Append(indent).Append("}");
+}
+
+PreProcessor::PreProcessor(List<String>& includeDir, Compiler* compiler, TokenCache* tokenCache) : root(nullptr), pchRoot(nullptr), pchFallback(""), tokenCache(tokenCache) {
 	this->includeDir = &includeDir;
 	this->compiler   = compiler;
 }
 
+PreProcessor::~PreProcessor() {
+	if (root)
+		DeleteFileNode(root);
+
+	if (pchRoot)
+		DeleteFileNode(pchRoot);
+}
+
+void PreProcessor::AddDefine(const String& name, const Tokens& value) {
+	uint64 loc = defines.Find(name, FindDefineCmp, 0);
+
+	if (loc != ~0) {
+		defines[loc].second = value;
+	} else {
+		defines.PushBack(std::pair(name, value));
+	}
+
+	loc = predefines.Find(name, FindDefineCmp, 0);
+
+	if (loc != ~0) {
+		predefines[loc].second = value;
+	} else {
+		predefines.PushBack(std::pair(name, value));
+	}
+}
+
+bool PreProcessor::AddDefine(const String& define) {
+	uint64 equal = define.Find('=', 0);
+
+	if (define.length == 0 || equal == 0) {
+		Log::Error("invalid define \"%s\"", define.str);
+		return false;
+	}
+
+	String name  = define;
+	String value = "1";
+
+	if (equal != String::npos) {
+		name  = define.SubString(0, equal - 1);
+		value = equal + 1 < define.length ? define.SubString(equal + 1, define.length - 1) : String("");
+	}
+
+	Tokens tokens;
+
+	if (value.length > 0) {
+		value.Append("\n"); // The lexer needs a delimiter after the last token
+		tokens = Lexer::Analyze(new SourceFile(String("<command line>"), value), Language::Default());
+	}
+
+	AddDefine(name, tokens);
+
+	return true;
+}
+
 bool PreProcessor::Run(Tokens& tokens) {
 	CorrectIncludeDir(*includeDir);
-	RemoveComments(tokens);
 
-	FileNode root = { tokens[0].loc.file->filename, nullptr };
+	if (root) {
+		DeleteFileNode(root);
+		fileNodes.clear();
+	}
+
+	root = AddFileNode(nullptr, tokens[0].loc.file->filename);
+
+	conditionals = List<ConditionalBlock>();
+
+	if (pchRoot) {
+		AddFileTree(root, pchRoot);
+	} else if (pchFallback.length > 0) {
+		AddFileNode(root, pchFallback);
+
+		Tokens res = LoadFile(pchFallback);
+		tokens.Insert(res, 0);
+	}
 
 	for (uint64 i = 0; i < tokens.GetSize(); i++) {
 		Token& t = tokens[i];
@@ -247,7 +337,7 @@ bool PreProcessor::Run(Tokens& tokens) {
 		Token& directive = tokens[i + 1];
 
 		if (directive.string == "include") {
-			if (!ProcessInclude(tokens, i-- + 2, *includeDir, &root))
+			if (!ProcessInclude(tokens, i-- + 2, *includeDir))
 				return false;
 		} else if (directive.string == "pragma") {
 			if (!ProcessPragma(tokens, i-- + 2))
@@ -266,10 +356,14 @@ bool PreProcessor::Run(Tokens& tokens) {
 		}
 	}
 
+	if (pchTokens.GetSize() > 0) {
+		tokens.Insert(pchTokens, 0);
+	}
+
 	return true;
 }
 
-bool PreProcessor::ProcessInclude(Tokens& tokens, uint64 index, const List<String>& includeDir, FileNode* nodes) {
+bool PreProcessor::ProcessInclude(Tokens& tokens, uint64 index, const List<String>& includeDir) {
 	Token& t = tokens[index];
 
 	bool local     = false;
@@ -307,7 +401,7 @@ bool PreProcessor::ProcessInclude(Tokens& tokens, uint64 index, const List<Strin
 	String finalFile;
 
 	if (local) {
-		if (FileUtils::FileExist(localPath + includeFile)) {
+		if (FileExist(localPath + includeFile)) {
 			finalFile = localPath + includeFile;
 		}
 	}
@@ -318,7 +412,7 @@ bool PreProcessor::ProcessInclude(Tokens& tokens, uint64 index, const List<Strin
 
 		const String& dir = includeDir[i];
 
-		if (FileUtils::FileExist(dir + includeFile)) {
+		if (FileExist(dir + includeFile)) {
 			finalFile = dir + includeFile;
 		}
 	}
@@ -328,7 +422,7 @@ bool PreProcessor::ProcessInclude(Tokens& tokens, uint64 index, const List<Strin
 		return false;
 	}
 
-	FileNode* current = FindCurrentNode(nodes, t.loc.file->filename);
+	FileNode* current = fileNodes[t.loc.file->filename];
 	FileNode* rec     = CheckRecursion(current, finalFile);
 
 	if (rec) {
@@ -339,14 +433,10 @@ bool PreProcessor::ProcessInclude(Tokens& tokens, uint64 index, const List<Strin
 	index -= 2;
 	tokens.Remove(index, newLine);
 
-	if (includedFiles.Find(finalFile) == ~0) { //Not already included
-		FileNode* node = new FileNode;
-
-		node->parent = current;
-		node->name   = finalFile;
-		current->files.PushBack(node);
+	if (includedFiles.count(finalFile) == 0) { //Not already included
+		AddFileNode(current, finalFile);
 
-		Tokens res = Lexer::Analyze(finalFile, Language::Default());
+		Tokens res = LoadFile(finalFile);
 		tokens.Insert(res, index);
 
 	} else {
@@ -362,7 +452,7 @@ bool PreProcessor::ProcessPragma(Tokens& tokens, uint64 index) {
 	uint64 end = FindNextNewline(tokens, index);
 
 	if (pragmaDirective.string == "once") {
-		includedFiles.PushBack(pragmaDirective.loc.file->filename);
+		includedFiles.insert(pragmaDirective.loc.file->filename);
 	} else {
 		Compiler::Log(pragmaDirective, HC_WARN_PREPROCESSOR_PRAGMA_UNKNOWN_DIRECTIVE, pragmaDirective.string.str);
 	}
@@ -406,10 +496,27 @@ bool PreProcessor::ProcessIf(Tokens& tokens, uint64 index) {
 
 	const String& ifType = tokens[index - 1].string;
 
+	ConditionalBlock block;
+
+	block.file    = tokens[index].loc.file;
+	block.line    = tokens[index].loc.line;
+	block.branch  = ~0;
+	block.start   = 0;
+	block.end     = ~0;
+	block.reached = false;
+
+	AddDependencies(block, tokens, index, newLine, ifType == "ifdef" || ifType == "ifndef");
+
+	for (uint64 elif : elifs) {
+		AddDependencies(block, tokens, elif + 2, FindNextNewline(tokens, elif + 2), false);
+	}
+
 	bool res = false;
 
 	if (ifType == "ifdef") {
 		res = defines.Find(tokens[index].string, FindDefineCmp, 0) != ~0;
+	} else if (ifType == "ifndef") {
+		res = defines.Find(tokens[index].string, FindDefineCmp, 0) == ~0;
 	} else {
 		res = EvaluateExpression(tokens, index, newLine) != 0;
 	}
@@ -419,6 +526,9 @@ bool PreProcessor::ProcessIf(Tokens& tokens, uint64 index) {
 	if (res) {
 		remStart = elifs.GetSize() > 0 ? elifs[0] : els != ~0 ? els
 															  : end;
+
+		SetKeptBranch(block, tokens, 0, newLine, remStart);
+
 		end += 1;
 
 		tokens.Remove(remStart, end);
@@ -432,6 +542,9 @@ bool PreProcessor::ProcessIf(Tokens& tokens, uint64 index) {
 			if (res) {
 				remStart = elifs.GetSize() > i + 1 ? elifs[i + 1] : els != ~0 ? els
 																			  : end;
+
+				SetKeptBranch(block, tokens, i + 1, newLine, remStart);
+
 				tokens.Remove(remStart, end + 1);
 				tokens.Remove(index - 2, newLine);
 				break;
@@ -442,15 +555,49 @@ bool PreProcessor::ProcessIf(Tokens& tokens, uint64 index) {
 			if (els == ~0) {
 				tokens.Remove(index - 2, end + 1);
 			} else {
+				SetKeptBranch(block, tokens, elifs.GetSize() + 1, els + 1, end);
+
 				tokens.Remove(end, end + 1);
 				tokens.Remove(index - 2, els + 1);
 			}
 		}
 	}
 
+	conditionals.PushBack(block);
+
 	return true;
 }
 
+void PreProcessor::AddDependencies(ConditionalBlock& block, const Tokens& tokens, uint64 start, uint64 end, bool evaluated) {
+	for (uint64 i = start; i <= end && i < tokens.GetSize(); i++) {
+		const String& name = tokens[i].string;
+
+		if (tokens[i].isString || name == "defined")
+			continue;
+
+		char c = name[0];
+
+		if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_'))
+			continue;
+
+		if (block.dependencies.Find(name) == ~0)
+			block.dependencies.PushBack(name);
+
+		if (!evaluated && block.unevaluated.Find(name) == ~0)
+			block.unevaluated.PushBack(name);
+	}
+}
+
+void PreProcessor::SetKeptBranch(ConditionalBlock& block, const Tokens& tokens, uint64 branch, uint64 directiveEnd, uint64 branchEnd) {
+	block.branch = branch;
+
+	// The branch is the tokens between the directive line and the next directive
+	if (directiveEnd + 1 < branchEnd) {
+		block.start = tokens[directiveEnd + 1].loc.index;
+		block.end   = tokens[branchEnd - 1].loc.index;
+	}
+}
+
 bool PreProcessor::ProcessError(Tokens& tokens, uint64 index) {
 	uint64 end = FindNextNewline(tokens, index);
 
@@ -482,6 +629,111 @@ uint64 PreProcessor::EvaluateExpression(Tokens& tokens, uint64 start, uint64 end
 	return false;
 }
 
+Tokens PreProcessor::LoadFile(const String& filename) {
+	if (tokenCache)
+		return tokenCache->Get(filename);
+
+	return Lexer::Analyze(filename, Language::Default());
+}
+
+bool PreProcessor::FileExist(const String& filename) {
+	if (tokenCache)
+		return tokenCache->FileExist(filename);
+
+	auto it = probedFiles.find(filename);
+
+	if (it != probedFiles.end())
+		return it->second;
+
+	bool res = FileUtils::FileExist(filename);
+
+	probedFiles.emplace(filename, res);
+
+	return res;
+}
+
+FileNode* PreProcessor::AddFileNode(FileNode* parent, const String& name) {
+	FileNode* node = new FileNode;
+
+	node->parent = parent;
+	node->name   = name;
+
+	if (parent)
+		parent->files.PushBack(node);
+
+	fileNodes.emplace(name, node);
+
+	return node;
+}
+
+void PreProcessor::AddFileTree(FileNode* parent, const FileNode* tree) {
+	FileNode* node = AddFileNode(parent, tree->name);
+
+	for (const FileNode* n : tree->files) {
+		AddFileTree(node, n);
+	}
+}
+
+bool PreProcessor::WritePrecompiledHeader(const String& filename, const Tokens& tokens) const {
+	return PrecompiledHeader::Write(filename, tokens, *this);
+}
+
+bool PreProcessor::UsePrecompiledHeader(const String& filename) {
+	return PrecompiledHeader::Load(filename, *this);
+}
+
+bool PreProcessor::WriteDependencyFile(const String& filename, const String& target, bool phony) const {
+	if (root == nullptr)
+		return false;
+
+	List<const FileNode*>      stack;
+	List<String>               files;
+	std::unordered_set<String> added;
+
+	stack.PushBack(root);
+
+	while (stack.GetSize() > 0) {
+		const FileNode* node = stack.Back();
+		stack.PopBack();
+
+		if (added.insert(node->name).second)
+			files.PushBack(node->name);
+
+		for (uint64 i = node->files.GetSize(); i > 0; i--) {
+			stack.PushBack(node->files[i - 1]);
+		}
+	}
+
+	String res = EscapeDependency(target) + ":";
+
+	for (const String& file : files) {
+		res.Append(" \\\n  ");
+		res.Append(EscapeDependency(file));
+	}
+
+	res.Append("\n");
+
+	if (phony) {
+		for (uint64 i = 1; i < files.GetSize(); i++) {
+			res.Append("\n").Append(EscapeDependency(files[i])).Append(":\n");
+		}
+	}
+
+	return FileUtils::WriteFile(filename, res.str, res.length);
+}
+
+bool PreProcessor::WriteIncludeGraph(const String& filename) const {
+	if (root == nullptr)
+		return false;
+
+	String json("");
+
+	WriteJsonNode(root, json, "");
+	json.Append("\n");
+
+	return FileUtils::WriteFile(filename, json.str, json.length);
+}
+
 bool PreProcessor::FindDefineCmp(const std::pair<String, Tokens>& item, const String& name) {
 	return item.first == name;
 }
\ No newline at end of file
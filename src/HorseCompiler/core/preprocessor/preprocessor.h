@@ -28,34 +28,96 @@ SOFTWARE
 #include <util/string.h>
 #include <util/list.h>
 
+#include <unordered_map>
+#include <unordered_set>
+
 struct FileNode {
 	String          name; // Name of this file
 	FileNode*       parent; // Parent file where it was included
 	List<FileNode*> files; // Files included in this file
 };
 
+void DeleteFileNode(FileNode* node);
+
+// A processed #if/#ifdef/#ifndef with its #elif/#else branches
+struct ConditionalBlock {
+	const SourceFile* file;
+	int64             line;         // Line of the #if
+	List<String>      dependencies; // Macros the conditions depend on
+	List<String>      unevaluated;  // Dependencies in #if/#elif expressions, which aren't evaluated yet and are always false
+	uint64            branch;       // Index of the kept branch, ~0 if every branch was removed
+	uint64            start;        // Source offset of the first token in the kept branch
+	uint64            end;          // Source offset of the last token in the kept branch, ~0 if it's empty
+	bool              reached;      // Set by the permutation analysis if the kept branch contributes to the final code
+};
+
+class TokenCache;
+
 class PreProcessor {
 private:
-	List<String>*                        includeDir;
-	List<String>                         includedFiles; // Files to be ignore if included again
-	List<std::pair<String, Tokens>> defines;
-	Compiler*                            compiler;
+	List<String>*                          includeDir;
+	std::unordered_set<String>             includedFiles; // Files to be ignore if included again
+	List<std::pair<String, Tokens>>        defines;
+	List<std::pair<String, Tokens>>        predefines; // Defines added before Run, a precompiled header is only used with the same set
+	Compiler*                              compiler;
+	FileNode*                              root;
+	std::unordered_map<String, FileNode*>  fileNodes; // First node of every file in the include tree
+	std::unordered_map<String, bool>       probedFiles; // Results of include path probing
+	Tokens                                 pchTokens; // Tokens of the precompiled header, inserted before the main file
+	FileNode*                              pchRoot; // Include tree of the precompiled header
+	String                                 pchFallback; // Header to preprocess from source if the precompiled header was out of date
+	TokenCache*                            tokenCache; // Shared lexed files, may be null
+	List<ConditionalBlock>                 conditionals; // Every conditional processed in the last Run
 
 public:
-	PreProcessor(List<String>& includeDir, Compiler* compiler);
+	PreProcessor(List<String>& includeDir, Compiler* compiler, TokenCache* tokenCache = nullptr);
+	~PreProcessor();
+
+	// Defines a macro before the source is processed, like -D on the command line
+	void AddDefine(const String& name, const Tokens& value);
+	// "NAME" or "NAME=VALUE", NAME defaults to 1
+	bool AddDefine(const String& define);
 
 	bool Run(Tokens& result);
 
+	// Conditionals of the last Run in the order they were processed
+	const List<ConditionalBlock>& GetConditionals() const { return conditionals; }
+
+	// Include tree of the last Run, root is the main file
+	const FileNode* GetIncludeTree() const { return root; }
+
+	// Writes a make style dependency file ("target: main.thsl header.thsl ...")
+	// phony adds an empty rule for every header so deleted headers doesn't break the build
+	bool WriteDependencyFile(const String& filename, const String& target, bool phony) const;
+	// Writes the include tree as json
+	bool WriteIncludeGraph(const String& filename) const;
+
+	// Serializes the state after the last Run (tokens, macros, #pragma once files and every file that contributed) into a precompiled header
+	bool WritePrecompiledHeader(const String& filename, const Tokens& tokens) const;
+	// Loads a precompiled header, its state is used as the prefix of the next Run. Returns false if it's invalid,
+	// if it's out of date the header it was created from is included from source instead
+	bool UsePrecompiledHeader(const String& filename);
+
 private:
-	bool ProcessInclude(Tokens& tokens, uint64 index, const List<String>& includeDir, FileNode* nodes);
+	bool ProcessInclude(Tokens& tokens, uint64 index, const List<String>& includeDir);
 	bool ProcessPragma(Tokens& tokens, uint64 index);
 	bool ProcessDefine(Tokens& tokens, uint64 index);
 	bool ProcessIf(Tokens& tokens, uint64 index);
 	bool ProcessError(Tokens& tokens, uint64 index);
 
+	void AddDependencies(ConditionalBlock& block, const Tokens& tokens, uint64 start, uint64 end, bool evaluated);
+	void SetKeptBranch(ConditionalBlock& block, const Tokens& tokens, uint64 branch, uint64 directiveEnd, uint64 branchEnd);
+
 	void   ReplaceDefine(Tokens& tokens, uint64 index);
 	uint64 EvaluateExpression(Tokens& tokens, uint64 start, uint64 end);
 
+	Tokens    LoadFile(const String& filename);
+	bool      FileExist(const String& filename);
+	FileNode* AddFileNode(FileNode* parent, const String& name);
+	void      AddFileTree(FileNode* parent, const FileNode* tree);
+
+	friend class PrecompiledHeader;
+
 private:
 	static bool FindDefineCmp(const std::pair<String, Tokens>& item, const String& name);
 };
@@ -0,0 +1,67 @@
+/*
+MIT License
+
+Copyright (c) 2021 Jesper
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE
+*/
+
+#include "tokencache.h"
+
+#include <core/compiler/lexer/lexer.h>
+#include <util/file.h>
+
+const Tokens& TokenCache::Get(const String& filename) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		auto it = files.find(filename);
+
+		if (it != files.end())
+			return it->second;
+	}
+
+	// Don't hold the lock while lexing, if another thread got here first its tokens are used
+	Tokens tokens = Lexer::Analyze(filename, Language::Default());
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	return files.emplace(filename, std::move(tokens)).first->second;
+}
+
+bool TokenCache::FileExist(const String& filename) {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	auto it = probedFiles.find(filename);
+
+	if (it != probedFiles.end())
+		return it->second;
+
+	bool res = FileUtils::FileExist(filename);
+
+	probedFiles.emplace(filename, res);
+
+	return res;
+}
+
+uint64 TokenCache::GetNumFiles() {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	return files.size();
+}
@@ -0,0 +1,47 @@
+/*
+MIT License
+
+Copyright (c) 2021 Jesper
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE
+*/
+
+#pragma once
+
+#include <util/string.h>
+#include <core/compiler/lexer/token.h>
+
+#include <mutex>
+#include <unordered_map>
+
+// Lexed files shared between preprocessors, every file is only read and lexed once.
+// Safe to use from multiple threads
+class TokenCache {
+private:
+	std::mutex                         mutex;
+	std::unordered_map<String, Tokens> files;
+	std::unordered_map<String, bool>   probedFiles; // Results of include path probing
+
+public:
+	// Returns the tokens of a file, lexing it the first time it's requested
+	const Tokens& Get(const String& filename);
+	bool          FileExist(const String& filename);
+
+	uint64 GetNumFiles();
+};
@@ -26,6 +26,15 @@ SOFTWARE
 #include <stdio.h>
 #include <string>
 
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 String FileUtils::LoadTextFile(const String& filename) {
 	uint64 size = 0;
 	byte*  tmp  = LoadFile(filename, &size);
@@ -60,4 +69,76 @@ bool FileUtils::FileExist(const String& filename) {
 	if (res) fclose(file);
 
 	return res;
+}
+
+bool FileUtils::WriteFile(const String& filename, const void* const data, uint64 size) {
+	FILE* file = fopen(filename.str, "wb");
+
+	if (!file) return false;
+
+	bool res = fwrite(data, 1, size, file) == size;
+
+	fclose(file);
+
+	return res;
+}
+
+const byte* FileUtils::MapFile(const String& filename, uint64* size) {
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filename.str, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (file == INVALID_HANDLE_VALUE) return nullptr;
+
+	LARGE_INTEGER fileSize;
+
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+		CloseHandle(file);
+		return nullptr;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+	CloseHandle(file);
+
+	if (mapping == nullptr) return nullptr;
+
+	void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+	CloseHandle(mapping);
+
+	if (data == nullptr) return nullptr;
+
+	*size = (uint64)fileSize.QuadPart;
+
+	return (const byte*)data;
+#else
+	int file = open(filename.str, O_RDONLY);
+
+	if (file < 0) return nullptr;
+
+	struct stat info;
+
+	if (fstat(file, &info) != 0 || info.st_size == 0) {
+		close(file);
+		return nullptr;
+	}
+
+	void* data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+
+	close(file);
+
+	if (data == MAP_FAILED) return nullptr;
+
+	*size = (uint64)info.st_size;
+
+	return (const byte*)data;
+#endif
+}
+
+void FileUtils::UnmapFile(const byte* data, uint64 size) {
+#ifdef _WIN32
+	UnmapViewOfFile(data);
+#else
+	munmap((void*)data, (size_t)size);
+#endif
 }
\ No newline at end of file
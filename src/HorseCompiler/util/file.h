@@ -32,4 +32,9 @@ public:
 	static String LoadTextFile(const String& filename);
 	static byte*  LoadFile(const String& filename, uint64* size);
 	static bool   FileExist(const String& filename);
+	static bool   WriteFile(const String& filename, const void* const data, uint64 size);
+
+	// Maps a file read only into memory, returns nullptr on failure
+	static const byte* MapFile(const String& filename, uint64* size);
+	static void        UnmapFile(const byte* data, uint64 size);
 };
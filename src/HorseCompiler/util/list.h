@@ -87,7 +87,7 @@ public:
 	uint64 Find(const T& item, uint64 offset = 0) const {
 		HC_ASSERT(offset >= 0 && offset <= GetSize());
 		for (uint64 i = offset; i < items.size(); i++) {
-			T& curr = items[i];
+			const T& curr = items[i];
 			if (curr == item)
 				return i;
 		}
@@ -195,6 +195,9 @@ public:
 
 	uint64 GetSize() const { return items.size(); }
 
+	T*       GetData() { return items.data(); }
+	const T* GetData() const { return items.data(); }
+
 	T& Back() {
 		return items.back();
 	}
@@ -25,6 +25,7 @@ SOFTWARE
 #include "string.h"
 #include <string>
 #include <core/error/error.h>
+#include "util.h"
 
 String::String(char* const string, uint64 length) : str(string), length(length) {
 	HC_ASSERT(string != nullptr && length > 0);
@@ -364,6 +365,13 @@ String& String::Replace(const String& start, const String& end, const char other
 	return Replace(start, end, (const char* const) & tmp);
 }
 
+uint64 String::Hash() const {
+	if (str == nullptr)
+		return 0;
+
+	return HashUtils::FNV1a(str, length);
+}
+
 void String::ToUpperCase(String& string) { }
 
 void String::ToLowerCase(String& string) { }
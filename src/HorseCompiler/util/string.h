@@ -25,6 +25,7 @@ SOFTWARE
 #pragma once
 
 #include <core/def.h>
+#include <functional>
 
 class String {
 public:
@@ -93,6 +94,8 @@ public:
 	String& Replace(const String& start, const String& end, const char* const other);
 	String& Replace(const String& start, const String& end, const char other);
 
+	uint64 Hash() const;
+
 	void ToUpperCase(String& string);
 	void ToLowerCase(String& string);
 
@@ -116,4 +119,11 @@ class TmpString : public String {
 public:
 	TmpString(const char* const str);
 	~TmpString();
-};
\ No newline at end of file
+};
+
+namespace std {
+template <>
+struct hash<String> {
+	size_t operator()(const String& string) const { return (size_t)string.Hash(); }
+};
+} // namespace std
\ No newline at end of file
@@ -26,6 +26,10 @@ SOFTWARE
 #include <core/error/error.h>
 #include <math.h>
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 uint64 GetValue(const char c) {
 	return c - (48 * (c >= '0' && c <= '9')) - (55 * (c >= 'A' && c <= 'F')) - (87 * (c >= 'a' && c <= 'f'));
 }
@@ -69,4 +73,54 @@ String StringUtils::GetPathFromFilename(String filename) {
 	}
 
 	return "";
+}
+
+uint64 HashUtils::FNV1a(const void* const data, uint64 size, uint64 hash) {
+	const byte* bytes = (const byte*)data;
+
+	for (uint64 i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= 0x100000001b3;
+	}
+
+	return hash;
+}
+
+uint32 ThreadUtils::GetNumThreads() {
+	uint32 num = std::thread::hardware_concurrency();
+
+	return num == 0 ? 1 : num;
+}
+
+void ThreadUtils::ParallelFor(uint64 count, uint32 numThreads, const std::function<void(uint64)>& func) {
+	if (numThreads == 0)
+		numThreads = GetNumThreads();
+
+	if (numThreads > count)
+		numThreads = (uint32)count;
+
+	if (numThreads <= 1) {
+		for (uint64 i = 0; i < count; i++)
+			func(i);
+
+		return;
+	}
+
+	std::atomic<uint64>      next(0);
+	std::vector<std::thread> threads;
+
+	auto worker = [&]() {
+		uint64 i;
+
+		while ((i = next.fetch_add(1)) < count)
+			func(i);
+	};
+
+	for (uint32 i = 1; i < numThreads; i++)
+		threads.emplace_back(worker);
+
+	worker();
+
+	for (std::thread& t : threads)
+		t.join();
 }
\ No newline at end of file
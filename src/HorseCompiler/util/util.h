@@ -26,10 +26,24 @@ SOFTWARE
 
 #include "string.h"
 
+#include <functional>
+
 class StringUtils {
 public:
 	static uint64 ToUint64(const String& string, uint8 base, uint64 start = 0, uint64 end = String::npos);
 	static uint64 ToUint64(const char* const string, uint8 base, uint64 start = 0, uint64 end = String::npos);
 	static void   ReplaceChar(String& string, char oldChar, char newChar);
 	static String GetPathFromFilename(String filename);
+};
+
+class HashUtils {
+public:
+	static uint64 FNV1a(const void* const data, uint64 size, uint64 hash = 0xcbf29ce484222325);
+};
+
+class ThreadUtils {
+public:
+	static uint32 GetNumThreads();
+	// Calls func with every index in [0, count) spread over numThreads threads, 0 uses every hardware thread
+	static void ParallelFor(uint64 count, uint32 numThreads, const std::function<void(uint64)>& func);
 };
\ No newline at end of file
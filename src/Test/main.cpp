@@ -1,38 +1,189 @@
 #include <core/log/log.h>
 #include <util/list.h>
 #include <util/file.h>
+#include <util/util.h>
 #include <core/error/error.h>
 #include <core/preprocessor/preprocessor.h>
 #include <core/compiler/compiler.h>
+#include <core/compiler/permutation.h>
 #include <core/compiler/lexer/lexer.h>
 #include <core/compiler/parsing/syntax.h>
+#include <core/compiler/parsing/astpool.h>
 #include <core/compiler/semantic/semantic.h>
+#include <core/compiler/reflection/reflection.h>
+#include <core/compiler/reflection/uniformpacking.h>
+#include <core/compiler/reflection/deadinterface.h>
+#include <core/compiler/pass/pass.h>
+#include <core/options.h>
 
 #include <chrono>
 #include <Windows.h>
 
+static double GetElapsed(std::chrono::high_resolution_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
 int main(int argc, char** argv) {
 	char buf[1024];
 
 	GetCurrentDirectoryA(1024, buf);
 
+	if (argc > 1) {
+		if (!Options::Parse(argc, argv))
+			return 1;
+	} else {
+		Options::inputFile = "test.c";
+	}
+
 	Compiler compiler(String(buf), Language::Default());
 
-	auto res = Lexer::Analyze("test.c", Language::Default());
+	if (Options::permutationFilename.length > 0) {
+		PermutationCompiler permutations(Options::includeDirs, &compiler);
+
+		if (!permutations.LoadPermutations(Options::permutationFilename))
+			return 1;
+
+		bool res = permutations.Run(Options::inputFile, Options::numThreads);
+
+		permutations.PrintStatistics();
+
+		if (!res)
+			return 1;
+
+		if (Options::prunePermutations) {
+			permutations.Prune(Options::entryPoint);
+			permutations.PrintEquivalenceClasses();
+
+			if (Options::permutationMapFilename.length > 0 && !permutations.WritePermutationMap(Options::permutationMapFilename)) {
+				Log::Error("failed to write permutation map \"%s\"", Options::permutationMapFilename.str);
+				return 1;
+			}
+		}
+
+		return 0;
+	}
+
+	PassManager passes;
 
-	List< String > includes;
+	auto phaseStart = std::chrono::high_resolution_clock::now();
+	auto res = Lexer::Analyze(Options::inputFile, Language::Default());
 
-	PreProcessor pp(includes, &compiler);
+	passes.RecordPhase("lex", GetElapsed(phaseStart), 0);
+
+	PreProcessor pp(Options::includeDirs, &compiler);
+
+	for (const String& define : Options::defines) {
+		if (!pp.AddDefine(define))
+			return 1;
+	}
+
+	if (Options::includePchFilename.length > 0) {
+		if (!pp.UsePrecompiledHeader(Options::includePchFilename))
+			return 1;
+	}
+
+	phaseStart = std::chrono::high_resolution_clock::now();
 
 	if (!pp.Run(res)) {
 		return 1;
 	}
 
+	passes.RecordPhase("preprocess", GetElapsed(phaseStart), 0);
+
+	if (Options::createPchFilename.length > 0) {
+		return pp.WritePrecompiledHeader(Options::createPchFilename, res) ? 0 : 1;
+	}
+
+	if (Options::dependencyFile) {
+		if (!pp.WriteDependencyFile(Options::dependencyFilename, Options::dependencyTarget, Options::dependencyPhony)) {
+			Log::Error("failed to write dependency file \"%s\"", Options::dependencyFilename.str);
+			return 1;
+		}
+	}
+
+	if (Options::includeGraphFilename.length > 0) {
+		if (!pp.WriteIncludeGraph(Options::includeGraphFilename)) {
+			Log::Error("failed to write include graph \"%s\"", Options::includeGraphFilename.str);
+			return 1;
+		}
+	}
+
 	SymbolTable symbols;
 	TypeTable types;
-	ASTNode* rootNode = new ASTNode(ASTType::Root);
+	ASTPool pool;
+	ASTNode* rootNode = nullptr;
+	ASTIndex root = ASTPool::Invalid;
+	uint64 cacheKey = 0;
+	String cacheFilename("");
+
+	phaseStart = std::chrono::high_resolution_clock::now();
+
+	if (Options::astCacheDir.length > 0) {
+		cacheKey = ASTPool::HashTokens(res);
+
+		// Skipped bodies depend on the entry point
+		if (Options::lazyBodies)
+			cacheKey = HashUtils::FNV1a(Options::entryPoint.str, Options::entryPoint.length, cacheKey);
+
+		snprintf(buf, sizeof(buf), "%s/%016llx.hast", Options::astCacheDir.str, cacheKey);
+		cacheFilename = buf;
+
+		if (pool.Load(cacheFilename, cacheKey, &root)) {
+			rootNode = pool.CreateTree(root);
+
+			if (Options::timePasses)
+				Log::Info("AST: loaded %llu nodes from \"%s\"", pool.GetNumNodes(), cacheFilename.str);
+		}
+	}
+
+	if (rootNode == nullptr) {
+		rootNode = new ASTNode(ASTType::Root);
+
+		uint64 parsed = Syntax::AnalyzeParallel(res, rootNode, Language::Default(), Options::numThreads, Options::lazyBodies);
+
+		if (parsed != ~0 && Options::lazyBodies) {
+			uint64 skipped = 0;
+
+			parsed = Syntax::ParseReachable(res, rootNode, Options::entryPoint, Language::Default(), &skipped);
+
+			Log::Info("skipped %llu function bodies not reachable from \"%s\"", skipped, Options::entryPoint.str);
+		}
+
+		// The passes work on the tree, the pool is only built to be written to the cache
+		if (parsed != ~0 && cacheFilename.length > 0) {
+			root = pool.Flatten(rootNode);
+
+			if (Options::timePasses)
+				Log::Info("AST: %llu nodes, %llu bytes in the pool, %llu bytes as a tree", pool.GetNumNodes(), pool.GetMemoryUsage(), ASTPool::GetTreeMemoryUsage(rootNode));
+
+			pool.Write(cacheFilename, cacheKey, root);
+		}
+
+		// The errors are already reported, the passes can't run on a partial tree
+		if (parsed == ~0)
+			return 1;
+	}
+
+	// Nothing after parsing refers to the tokens
+	res = Tokens();
+
+	passes.RecordPhase("parse", GetElapsed(phaseStart), pool.GetNumNodes());
+
+	passes.AddPass(new SemanticPass(&types, &symbols, pool.GetConstantPool(), Options::numThreads));
+
+	// Unused members are removed before the blocks are packed
+	if (!Options::keepInterface)
+		passes.AddPass(new DeadInterfacePass(&symbols, Options::entryPoint));
+
+	if (Options::packUniforms)
+		passes.AddPass(new UniformPackingPass(&symbols, Options::uniformLayout));
+
+	passes.AddPass(new ReflectionPass(&symbols, Options::uniformLayout, Options::reflectionFilename));
+
+	bool analyzed = passes.Run(rootNode);
 
+	if (Options::timePasses)
+		passes.PrintStatistics();
 
-	Syntax::Analyze(res, 0, rootNode, Language::Default());
-	Semantic::Analyze(rootNode, &types, &symbols);
+	return analyzed ? 0 : 1;
 }